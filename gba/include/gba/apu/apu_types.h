@@ -8,6 +8,9 @@
 #ifndef GAMEBOIADVANCE_APU_TYPES_H
 #define GAMEBOIADVANCE_APU_TYPES_H
 
+#include <algorithm>
+#include <cstring>
+
 #include <gba/cpu/dma_controller.h>
 #include <gba/core/container.h>
 #include <gba/core/math.h>
@@ -303,6 +306,7 @@ struct polynomial_counter {
 struct pulse_channel {
 private:
     scheduler* scheduler_;
+    scheduler::event_source event_source_;
     scheduler::hw_event::handle timer_event_id;
 
 public:
@@ -328,7 +332,7 @@ public:
     bool enabled = true;
     bool dac_enabled = true;
 
-    explicit pulse_channel(scheduler* scheduler) noexcept;
+    pulse_channel(scheduler* scheduler, scheduler::event_source event_source) noexcept;
 
     void generate_output_sample(u32 late_cycles) noexcept;
     [[nodiscard]] i8 get_output() const noexcept;
@@ -486,6 +490,32 @@ public:
         }
     }
 
+    // 32 bit writes push four samples, lowest byte first
+    void write_word(const u32 samples) noexcept
+    {
+        if(LIKELY(size_ + 4_u32 <= capacity && write_idx_ + 4_u32 <= capacity)) {
+            memcpy(data_, write_idx_, samples);
+            write_idx_ = (write_idx_ + 4_u32) % capacity;
+            size_ += 4_u32;
+            return;
+        }
+
+        for(u32 i = 0_u32; i < 4_u32; ++i) {
+            write(narrow<u8>(samples >> (8_u32 * i)));
+        }
+    }
+
+    // dma refills push their samples at once, whatever does not fit is dropped
+    void write_samples(const view<u8> samples) noexcept
+    {
+        const usize count = std::min(samples.size(), usize{capacity - size_});
+        const usize until_wrap = std::min(count, usize{capacity - write_idx_});
+        std::memcpy(data_.ptr(usize{write_idx_}), samples.data(), until_wrap.get());
+        std::memcpy(data_.data(), samples.ptr(until_wrap), (count - until_wrap).get());
+        write_idx_ = (write_idx_ + narrow<u32>(count)) % capacity;
+        size_ += narrow<u32>(count);
+    }
+
     [[nodiscard]] u8 read() noexcept
     {
         const u8 value = data_[read_idx_];
@@ -65,7 +65,7 @@ public:
     [[nodiscard]] virtual u8 read(u32 address) const noexcept = 0;
 
     virtual void set_size(usize size) noexcept;
-    void set_scheduler(scheduler* s) noexcept { scheduler_ = s; }
+    virtual void set_scheduler(scheduler* s) noexcept { scheduler_ = s; }
 
     virtual void serialize(archive& archive) const noexcept;
     virtual void deserialize(const archive& archive) noexcept;
@@ -100,22 +100,17 @@ public:
     // intentionally not initialize the size,
     // so we can figure it out on the first write
     explicit backup_eeprom(const fs::path& pak_path)
-      : backup(pak_path, 8_kb)
-    {
-        register_settle_event();
-    }
+      : backup(pak_path, 8_kb) {}
 
     backup_eeprom(const fs::path& pak_path, const usize size)
       : backup(pak_path, size),
-        bus_width_{size == 8_kb ? 14_u8 : 6_u8}
-    {
-        register_settle_event();
-    }
+        bus_width_{size == 8_kb ? 14_u8 : 6_u8} {}
 
     void write(u32 address, u8 value) noexcept final;
     [[nodiscard]] u8 read(u32 address) const noexcept final;
 
     void set_size(usize size) noexcept final;
+    void set_scheduler(scheduler* s) noexcept final;
 
     [[nodiscard]] u32 get_addr() const noexcept { return address_; }
 
@@ -123,8 +118,6 @@ public:
     void deserialize(const archive& archive) noexcept final;
 
 private:
-    void register_settle_event() noexcept;
-
     void reset_buffer() const noexcept { buffer_ = 0_u64; transmission_count_ = 0_u8; }
     void on_settle(u32 /*late_cycles*/) noexcept
     {
@@ -8,10 +8,13 @@
 #ifndef GAMEBOIADVANCE_GAMEPAK_H
 #define GAMEBOIADVANCE_GAMEPAK_H
 
+#include <chrono>
 #include <memory>
+#include <string>
 #include <string_view>
 
 #include <gba/cartridge/backup.h>
+#include <gba/cartridge/rom_image.h>
 #include <gba/cartridge/rtc.h>
 #include <gba/core/event/event.h>
 #include <gba/core/fwd.h>
@@ -19,11 +22,23 @@
 
 namespace gba::cartridge {
 
+struct pak_load_stats {
+    std::chrono::microseconds image_time{0};
+    std::chrono::microseconds header_time{0};
+    std::chrono::microseconds backup_detection_time{0};
+    std::chrono::microseconds total_time{0};
+    usize rom_size;
+    bool mapped = false;
+    bool backup_scan_cached = false;
+};
+
 class gamepak {
     friend core;
 
     fs::path path_;
-    vector<u8> pak_data_;
+    std::string save_suffix_;
+    // shared between every core running the same rom
+    std::shared_ptr<const rom_image> pak_data_ = std::make_shared<const rom_image>();
 
     rtc rtc_;
 
@@ -42,6 +57,8 @@ class gamepak {
     bool has_mirroring_ = false;
     u32 mirror_mask_;
 
+    pak_load_stats load_stats_;
+
 public:
 #if WITH_DEBUGGER
     event<> on_eeprom_width_detected_event;
@@ -58,6 +75,11 @@ public:
     [[nodiscard]] bool loaded() const noexcept { return loaded_; }
     [[nodiscard]] backup::type backup_type() const noexcept { return backup_type_; }
     [[nodiscard]] const fs::path& path() const noexcept { return path_; }
+    [[nodiscard]] fs::path save_base_path() const;
+
+    // keeps backups and save states of several instances of one rom apart, applies on the next load
+    void set_save_suffix(std::string suffix) noexcept { save_suffix_ = std::move(suffix); }
+    [[nodiscard]] const pak_load_stats& get_load_stats() const noexcept { return load_stats_; }
 
     void on_eeprom_bus_width_detected(backup::type eeprom_type) noexcept;
 
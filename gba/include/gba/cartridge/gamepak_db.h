@@ -11,6 +11,8 @@
 #include <optional>
 
 #include <gba/cartridge/backup.h>
+#include <gba/core/container.h>
+#include <gba/helper/filesystem.h>
 
 namespace gba::cartridge {
 
@@ -21,8 +23,16 @@ struct pak_db_entry {
     bool has_mirroring;
 };
 
+// checks the external database first if one is loaded, then the built-in one
 std::optional<pak_db_entry> query_pak_db(std::string_view game_code) noexcept;
 
+// maps an external database whose entries take precedence over the built-in ones, thread safe
+bool load_pak_db_overlay(const fs::path& path) noexcept;
+void clear_pak_db_overlay() noexcept;
+
+// writes entries in the external database format
+void write_pak_db(const fs::path& path, vector<pak_db_entry> entries);
+
 } // namespace gba::cartridge
 
 #endif //GAMEBOIADVANCE_GAMEPAK_DB_H
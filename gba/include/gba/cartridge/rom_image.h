@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#ifndef GAMEBOIADVANCE_ROM_IMAGE_H
+#define GAMEBOIADVANCE_ROM_IMAGE_H
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+#include <gba/cartridge/backup.h>
+#include <gba/core/container.h>
+#include <gba/helper/filesystem.h>
+
+namespace gba::cartridge {
+
+// a backup library signature and where it starts in the rom
+struct backup_signature {
+    backup::type type = backup::type::detect;
+    std::string_view name;
+    usize offset;
+};
+
+/*
+ * Immutable rom contents. Uncompressed roms are mapped read-only, gzipped ones are
+ * decompressed into memory once. Images are cached by path while anything holds
+ * them, so every core running the same game reads from the same bytes.
+ */
+class rom_image {
+    fs::mmap mapping_;
+    vector<u8> bytes_;
+
+    const u8* data_ = nullptr;
+    usize size_;
+
+    mutable std::once_flag backup_scan_flag_;
+    mutable backup_signature scanned_signature_;
+
+public:
+    // the whole rom address space
+    static constexpr usize max_size = 0x0200'0000_usize;
+
+    using value_type = u8;
+    using size_type = usize;
+    using const_reference = u8;
+    using const_pointer = const u8*;
+    using const_iterator = const_pointer;
+
+    rom_image() noexcept = default;
+    explicit rom_image(fs::mmap mapping) noexcept;
+    explicit rom_image(vector<u8> bytes) noexcept;
+    rom_image(vector<u8> bytes, const backup_signature& scanned_signature) noexcept;
+
+    rom_image(const rom_image&) = delete;
+    rom_image(rom_image&&) = delete;
+    rom_image& operator=(const rom_image&) = delete;
+    rom_image& operator=(rom_image&&) = delete;
+
+    // returns the cached image of path if one is alive, thread safe
+    [[nodiscard]] static std::shared_ptr<const rom_image> open(const fs::path& path);
+
+    [[nodiscard]] u8 operator[](const usize idx) const noexcept { return *ptr(idx); }
+    [[nodiscard]] const u8* ptr(const usize idx) const noexcept { return data_ + idx.get(); }
+    [[nodiscard]] u8 at(const usize idx) const noexcept { ASSERT(idx < size_); return *ptr(idx); }
+    [[nodiscard]] const u8* data() const noexcept { return data_; }
+
+    [[nodiscard]] usize size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0_usize; }
+    [[nodiscard]] bool is_mapped() const noexcept { return mapping_.is_mapped(); }
+
+    // first library signature found in the rom, type::detect if there is none.
+    // scanned once per image, gzipped roms are scanned while they are being inflated
+    [[nodiscard]] backup_signature scan_backup_signature() const noexcept;
+    [[nodiscard]] backup::type scan_backup_type() const noexcept { return scan_backup_signature().type; }
+
+    // the signature called name if the rom contains it at offset
+    [[nodiscard]] std::optional<backup_signature> backup_signature_at(std::string_view name, usize offset) const noexcept;
+
+    [[nodiscard]] u8 front() const noexcept { return at(0_usize); }
+    [[nodiscard]] u8 back() const noexcept { return at(size() - 1_usize); }
+
+    [[nodiscard]] const_iterator begin() const noexcept { return data_; }
+    [[nodiscard]] const_iterator end() const noexcept { return ptr(size_); }
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+};
+
+} // namespace gba::cartridge
+
+#endif //GAMEBOIADVANCE_ROM_IMAGE_H
@@ -13,6 +13,7 @@
 #include <gba/cartridge/gamepak.h>
 #include <gba/core/scheduler.h>
 #include <gba/cpu/cpu.h>
+#include <gba/helper/function_ptr.h>
 #include <gba/helper/gzip.h>
 #include <gba/keypad.h>
 #include <gba/ppu/ppu.h>
@@ -32,6 +33,14 @@ class core : public cpu::bus_interface {
     archive default_state_;
     fs::path states_path_;
 
+    /*
+     * Bus accesses are counted against a local budget, the cycles to the next event at the last
+     * sync, and reach the scheduler only once it runs out, around io accesses, which can read or
+     * change timing, and at the end of tick. While a dma is pending or running the budget is zero.
+     */
+    u32 pending_cycles_;
+    u32 cycle_budget_;
+
 public:
 #if WITH_DEBUGGER
     delegate<void(u32, cpu::debugger_access_width)> on_io_read;
@@ -50,6 +59,8 @@ public:
         ppu_engine_.set_irq_controller_handle(cpu_.get_interrupt_handle());
         gamepak_.set_irq_controller_handle(cpu_.get_interrupt_handle());
         // sio_engine_.set_irq_controller_handle(arm.get_interrupt_handle());
+
+        update_page_table();
     }
 
     [[nodiscard]] event<u8, const ppu::scanline_buffer&>& on_scanline_event() noexcept { return ppu_engine_.event_on_scanline; }
@@ -59,13 +70,22 @@ public:
     FORCEINLINE void set_volume(const float volume) noexcept { apu_engine_.set_volume(volume); }
     FORCEINLINE void set_dst_sample_rate(const u32 sample_rate) noexcept { apu_engine_.set_dst_sample_rate(sample_rate); }
     FORCEINLINE void set_sound_buffer_capacity(const usize capacity) noexcept { apu_engine_.set_buffer_capacity(capacity); }
+    FORCEINLINE void set_idle_loop_skipping(const bool enabled) noexcept { cpu_.set_idle_loop_skipping(enabled); }
+    FORCEINLINE void set_native_swi_fast_paths(const bool enabled) noexcept { cpu_.set_native_swi_fast_paths(enabled); }
+    void set_threaded_rendering(const bool enabled) { ppu_engine_.set_threaded_rendering(enabled); }
+    [[nodiscard]] bool threaded_rendering() const noexcept { return ppu_engine_.threaded_rendering(); }
+    [[nodiscard]] const cpu::idle_loop_stats& idle_loop_stats() const noexcept { return cpu_.get_idle_loop_stats(); }
+    [[nodiscard]] u64 executed_instruction_count() const noexcept { return cpu_.executed_instruction_count(); }
+    [[nodiscard]] u64 elapsed_cycles() const noexcept { return scheduler_.now() + pending_cycles_; }
 
     void tick(u32 cycles = 1_u32) noexcept
     {
+        sync_cycles();
         const u64 until = scheduler_.now() + cycles;
-        while(scheduler_.now() < until) {
+        while(elapsed_cycles() < until) {
             cpu_.tick();
         }
+        sync_cycles();
     }
 
     void tick_one_frame() noexcept { tick(ppu::engine::cycles_per_frame); }
@@ -82,14 +102,25 @@ public:
     [[nodiscard]] std::string_view game_title() const noexcept { return gamepak_.game_title(); }
     [[nodiscard]] const fs::path& pak_path() const noexcept { return gamepak_.path(); }
     [[nodiscard]] bool pak_loaded() const noexcept { return gamepak_.loaded(); }
+    [[nodiscard]] const cartridge::pak_load_stats& pak_load_stats() const noexcept { return gamepak_.get_load_stats(); }
+    // must be set before load_pak, see gamepak::set_save_suffix
+    void set_save_suffix(std::string suffix) noexcept { gamepak_.set_save_suffix(std::move(suffix)); }
+
     void load_pak(const fs::path& path)
     {
+        if(pak_loaded()) {
+            LOG_INFO(core, "{}: skipped {} idle cycles in {} idle loops", game_title(),
+              idle_loop_stats().skipped_cycles, idle_loop_stats().skip_count);
+        }
+
         gamepak_.load(path);
+        update_page_table();
+        cpu_.reset_idle_loop_stats();
 
         if(pak_loaded()) {
             gamepak_.set_scheduler(&scheduler_);
 
-            states_path_ = path.parent_path() / "states" / path.filename();
+            states_path_ = path.parent_path() / "states" / gamepak_.save_base_path().filename();
             states_path_.replace_extension();
 
             if(!fs::exists(states_path_) && !fs::create_directories(states_path_)) {
@@ -186,6 +217,7 @@ private:
 
     void deserialize(const archive& archive) noexcept
     {
+        pending_cycles_ = 0_u32;
         scheduler_.deserialize(archive);
         gamepak_.deserialize(archive);
         cpu_.deserialize(archive);
@@ -201,21 +233,79 @@ private:
     void write_16(u32 addr, u16 data, cpu::mem_access access) noexcept final { write<u16>(addr, data, access); }
     [[nodiscard]] u8 read_8(u32 addr, cpu::mem_access access) noexcept final { return read<u8>(addr, access); }
     void write_8(u32 addr, u8 data, cpu::mem_access access) noexcept final { write<u8>(addr, data, access); }
+    void tick_fetch_32(u32 addr, cpu::mem_access access) noexcept final { tick_fetch<u32>(addr, access); }
+    void tick_fetch_16(u32 addr, cpu::mem_access access) noexcept final { tick_fetch<u16>(addr, access); }
+    void tick_burst_32(u32 addr, u32 count) noexcept final { tick_burst<u32>(addr, count); }
+    void tick_burst_16(u32 addr, u32 count) noexcept final { tick_burst<u16>(addr, count); }
+    [[nodiscard]] u32 access_cycles_32(u32 addr, cpu::mem_access access) noexcept final { return access_cycles<u32>(addr, access); }
+    [[nodiscard]] u32 access_cycles_16(u32 addr, cpu::mem_access access) noexcept final { return access_cycles<u16>(addr, access); }
+    [[nodiscard]] view<u8> readable_memory(u32 addr) noexcept final;
+    [[nodiscard]] u8* writable_memory(u32 addr, usize size) noexcept final;
+    void write_sound_fifo(u32 addr, view<u8> samples) noexcept final;
+
+    void update_page_table() noexcept;
 
     [[nodiscard]] u8 read_io(u32 addr) noexcept;
     void write_io(u32 addr, u8 data) noexcept;
 
+    // registers with native 16/32 bit handlers, everything else falls back to byte accesses
+    struct io_register {
+        function_ptr<core, u16(u32)> read_16;
+        function_ptr<core, void(u32, u16)> write_16;
+        function_ptr<core, u32(u32)> read_32;
+        function_ptr<core, void(u32, u32)> write_32;
+    };
+
+    static constexpr usize io_register_count = 0x200_usize; // one entry per halfword in 0x0400'0000-0x0400'03FF
+    static const array<io_register, io_register_count.get()> io_registers_;
+
+    [[nodiscard]] static FORCEINLINE const io_register* find_io_register(const u32 addr) noexcept
+    {
+        const usize index{(addr & 0x00FF'FFFF_u32) >> 1_u32};
+        return index < io_register_count ? &io_registers_[index] : nullptr;
+    }
+
+    template<typename T> [[nodiscard]] T read_io_register(u32 addr) noexcept;
+    template<typename T> void write_io_register(u32 addr, T data) noexcept;
+
+    [[nodiscard]] u16 read_keyinput(u32 addr) noexcept;
+    [[nodiscard]] u16 read_dispstat(u32 addr) noexcept;
+    [[nodiscard]] u16 read_vcount(u32 addr) noexcept;
+    [[nodiscard]] u16 read_ie(u32 addr) noexcept;
+    [[nodiscard]] u16 read_if(u32 addr) noexcept;
+    [[nodiscard]] u16 read_ime(u32 addr) noexcept;
+    template<u32::type Id> [[nodiscard]] u16 read_timer_counter(u32 addr) noexcept;
+    template<u32::type Id> [[nodiscard]] u32 read_timer(u32 addr) noexcept;
+
+    void write_dispstat(u32 addr, u16 data) noexcept;
+    void write_ie(u32 addr, u16 data) noexcept;
+    void write_if(u32 addr, u16 data) noexcept;
+    void write_ime(u32 addr, u16 data) noexcept;
+    template<u32::type Id> void write_dma_cnt_h(u32 addr, u16 data) noexcept;
+    template<u32::type Id> void write_dma_address(u32 addr, u32 data) noexcept;
+    template<u32::type Id> void write_dma_cnt(u32 addr, u32 data) noexcept;
+    template<u32::type Id> void write_timer(u32 addr, u32 data) noexcept;
+    template<bool IsFifoA> void write_fifo(u32 addr, u32 data) noexcept;
+
     void idle() noexcept final { tick_components(1_u32); }
     void tick_components(const u32 cycles) noexcept final
     {
-        if(UNLIKELY(!cpu_.dma_controller_.is_running() && cpu_.dma_controller_.should_start_running())) {
-            cpu_.dma_controller_.run_channels();
+        if(UNLIKELY(pending_cycles_ + cycles >= cycle_budget_)) {
+            sync_components(cycles);
+        } else {
+            pending_cycles_ += cycles;
         }
-
-        scheduler_.add_cycles(cycles);
         cpu_.prefetch_tick(cycles);
     }
+    [[nodiscard]] u32 cycles_to_next_event() noexcept final { return cycle_budget_ - pending_cycles_; }
+
+    void sync_components(u32 cycles) noexcept;
+    void sync_cycles() noexcept;
 
+    template<typename T> void tick_access(u32 address, cpu::memory_page page, cpu::mem_access access) noexcept;
+    template<typename T> void tick_fetch(u32 address, cpu::mem_access access) noexcept;
+    template<typename T> void tick_burst(u32 address, u32 count) noexcept;
+    template<typename T> [[nodiscard]] u32 access_cycles(u32 address, cpu::mem_access access) noexcept;
     template<typename T> T read(u32 address, cpu::mem_access access) noexcept;
     template<typename T> void write(u32 address, T data, cpu::mem_access access) noexcept;
 };
@@ -8,6 +8,10 @@
 #ifndef GAMEBOIADVANCE_MATH_H
 #define GAMEBOIADVANCE_MATH_H
 
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif // defined(_MSC_VER)
+
 #include <gba/core/integer.h>
 #include <gba/helper/macros.h>
 
@@ -48,6 +52,19 @@ template<typename T>
     return narrow<u8>((t >> (n * 8_u8)) & 0xFF_u8);
 }
 
+// index of the lowest set bit, t must not be zero
+[[nodiscard]] FORCEINLINE u32 lowest_set(const u64 t) noexcept
+{
+    ASSERT(t != 0_u64);
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, t.get());
+    return static_cast<u32::type>(idx);
+#else
+    return static_cast<u32::type>(__builtin_ctzll(t.get()));
+#endif // defined(_MSC_VER)
+}
+
 } // namespace bit
 
 namespace mask {
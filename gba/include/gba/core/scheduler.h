@@ -9,7 +9,6 @@
 #define GAMEBOIADVANCE_SCHEDULER_H
 
 #include <algorithm>
-#include <functional>   // std::greater
 #include <string_view>
 #include <type_traits>  // std::forward
 
@@ -21,6 +20,7 @@
 
 namespace gba {
 
+// maps event callbacks to stable names so that scheduled events survive save states
 class hw_event_registry {
 public:
     struct entry {
@@ -35,12 +35,6 @@ private:
     vector<entry> entries_;
 
 public:
-    [[nodiscard]] static hw_event_registry& get() noexcept
-    {
-        static hw_event_registry registry;
-        return registry;
-    }
-
     void register_entry(const delegate<void(u32)> callback,
       const std::string_view name) noexcept
     {
@@ -70,6 +64,29 @@ public:
 
 class scheduler {
 public:
+    // hardware sources which never have more than one event in flight
+    enum class event_source : u8::type {
+        ppu,
+        apu_sequencer,
+        apu_mixer,
+        apu_pulse1,
+        apu_pulse2,
+        apu_wave,
+        apu_noise,
+        timer0,
+        timer1,
+        timer2,
+        timer3,
+        dma0,
+        dma1,
+        dma2,
+        dma3,
+        irq,
+        eeprom
+    };
+
+    static constexpr usize event_source_count = 17_usize;
+
     // represents an hardware event
     struct hw_event {
         using handle = u64;
@@ -77,107 +94,166 @@ public:
         delegate<void(u32 /*late_cycles*/)> callback;
         u64 timestamp;
         handle h;
+    };
 
-        bool operator>(const hw_event& other) const noexcept { return timestamp > other.timestamp; }
-
-        template<typename Ar>
-        void serialize(Ar& archive) const noexcept
-        {
-            const hw_event_registry& event_registry = hw_event_registry::get();
-            const hw_event_registry::entry* event_entry = event_registry.find_by_callback(callback);
-            if(!event_entry) {
-                LOG_CRITICAL(scheduler, "unencountered event callback");
-                PANIC();
-            }
-
-            archive.serialize(event_entry->name);
-            archive.serialize(timestamp);
-            archive.serialize(h);
-        }
+private:
+    /*
+     * Every live event lives in the slot selected by the low bits of its handle,
+     * so looking up or cancelling an event does not need to search.
+     * Handles which would land on an occupied slot are never given out.
+     * Slots are ordered by an indexed binary heap, ties are fired in scheduling order.
+     */
+    struct slot {
+        hw_event event;
+        u32 heap_index;
+        bool active = false;
+    };
 
-        template<typename Ar>
-        void deserialize(const Ar& archive) noexcept
-        {
-            const std::string_view event_name = archive.template deserialize<std::string_view>();
+    /*
+     * Events of the fixed sources skip the heap altogether, each source owns a timestamp in a flat table.
+     * The next deadline is a branchless min over that table and the heap top, cached until the set changes.
+     * Handles of these events have the top bit set and carry their source in the lowest byte.
+     */
+    struct fixed_event {
+        delegate<void(u32)> callback;
+        hw_event::handle h;
+    };
 
-            const hw_event_registry& event_registry = hw_event_registry::get();
-            const hw_event_registry::entry* event_entry = event_registry.find_by_name(event_name);
-            if(!event_entry) {
-                LOG_CRITICAL(scheduler, "corrupted serialized event data {}", event_name);
-                PANIC();
-            }
+    static constexpr usize initial_slot_count = 64_usize;
+    static constexpr u64 inactive_timestamp{numeric_limits<u64>::max()};
+    static constexpr u64 fixed_handle_bit = 1_u64 << 63_u64;
 
-            callback = event_entry->callback;
-            archive.deserialize(timestamp);
-            archive.deserialize(h);
-        }
-    };
+    vector<slot> slots_{initial_slot_count};
+    vector<u32> heap_;
+    u64 slot_mask_ = initial_slot_count.get() - 1_u64;
 
-private:
-    using predicate = std::greater<scheduler::hw_event>;
+    array<u64, event_source_count.get()> fixed_timestamps_;
+    array<fixed_event, event_source_count.get()> fixed_events_;
 
-    vector<hw_event> heap_;
+    u64 next_timestamp_ = inactive_timestamp;
     u64 now_;
     u64 next_event_handle_;
 
+    // every core owns its scheduler, so names are resolved per instance
+    hw_event_registry event_registry_;
+
 public:
     scheduler()
     {
-        heap_.reserve(64_usize);
+        heap_.reserve(initial_slot_count);
+        std::fill(fixed_timestamps_.begin(), fixed_timestamps_.end(), inactive_timestamp);
+    }
+
+    hw_event::handle add_hw_event(const event_source source, const u32 delay, const delegate<void(u32)> callback)
+    {
+        const usize idx = from_enum<usize>(source);
+        if(UNLIKELY(fixed_timestamps_[idx] != inactive_timestamp)) {
+            // source has an event in flight already, let the heap keep this one
+            return add_hw_event(delay, callback);
+        }
+
+        ++next_event_handle_;
+        const hw_event::handle handle = fixed_handle_bit | next_event_handle_ << 8_u64 | from_enum<u64>(source);
+        insert_fixed(hw_event{callback, now_ + delay, handle});
+        return handle;
     }
 
     hw_event::handle add_hw_event(const u32 delay, const delegate<void(u32)> callback)
     {
-        heap_.push_back(hw_event{callback, now_ + delay, ++next_event_handle_});
-        std::push_heap(heap_.begin(), heap_.end(), predicate{});
+        if(UNLIKELY(heap_.size() == slots_.size())) {
+            grow_slots();
+        }
+
+        do {
+            ++next_event_handle_;
+        } while(slot_of(next_event_handle_).active);
+
+        insert(hw_event{callback, now_ + delay, next_event_handle_});
         return next_event_handle_;
     }
 
-    [[nodiscard]] bool has_event(const hw_event::handle handle)
+    [[nodiscard]] hw_event_registry& event_registry() noexcept { return event_registry_; }
+    [[nodiscard]] const hw_event_registry& event_registry() const noexcept { return event_registry_; }
+
+    [[nodiscard]] bool has_event(const hw_event::handle handle) const noexcept
     {
-        const auto it = std::find_if(heap_.begin(), heap_.end(), [handle](const hw_event& e) {
-            return e.h == handle;
-        });
+        if(is_fixed(handle)) {
+            const usize idx = source_of(handle);
+            return fixed_timestamps_[idx] != inactive_timestamp && fixed_events_[idx].h == handle;
+        }
 
-        return it != heap_.end();
+        const slot& s = slot_of(handle);
+        return s.active && s.event.h == handle;
     }
 
     void remove_event(const hw_event::handle handle)
     {
-        const auto it = std::remove_if(heap_.begin(), heap_.end(), [handle](const hw_event& e) {
-            return e.h == handle;
-        });
+        if(!has_event(handle)) {
+            return;
+        }
 
-        if(it != heap_.end()) {
-            heap_.erase(it, heap_.end());
-            std::make_heap(heap_.begin(), heap_.end(), predicate{});
+        if(is_fixed(handle)) {
+            erase_fixed(source_of(handle));
+        } else {
+            erase(slot_of(handle).heap_index);
         }
     }
 
     void add_cycles(const u32 cycles) noexcept
     {
         now_ += cycles;
-        if(const u64 next_event = timestamp_of_next_event(); UNLIKELY(next_event <= now_)) {
-            while(!heap_.empty() && timestamp_of_next_event() <= now_) {
-                const auto [callback, timestamp, handle] = heap_.front();
+        if(UNLIKELY(next_timestamp_ <= now_)) {
+            do {
+                fire_next_event();
+            } while(next_timestamp_ <= now_);
+        }
+    }
 
-                std::pop_heap(heap_.begin(), heap_.end(), predicate{});
-                heap_.pop_back();
+    [[nodiscard]] u64 now() const noexcept { return now_; }
+    [[nodiscard]] u64 timestamp_of_next_event() const noexcept { ASSERT(next_timestamp_ != inactive_timestamp); return next_timestamp_; }
+    [[nodiscard]] u32 remaining_cycles_to_next_event() const noexcept { return narrow<u32>(timestamp_of_next_event() - now()); }
 
-                // call with how much cycles the event has been late
-                callback(narrow<u32>(now_ - timestamp));
+    // cycles that can pass before an event fires, zero if one is already due.
+    // sources set in the ignored_sources mask do not count
+    [[nodiscard]] u64 cycles_before_next_event(const u32 ignored_sources = 0_u32) const noexcept
+    {
+        u64 next = next_timestamp_;
+        if(ignored_sources != 0_u32) {
+            next = heap_.empty() ? inactive_timestamp : slots_[heap_.front()].event.timestamp;
+            for(usize idx = 0_usize; idx < event_source_count; ++idx) {
+                if((ignored_sources & (1_u32 << narrow<u32>(idx))) == 0_u32) {
+                    next = std::min(next, fixed_timestamps_[idx]);
+                }
             }
         }
+
+        const u64 current = now();
+        return next > current ? next - current : 0_u64;
     }
 
-    [[nodiscard]] u64 now() const noexcept { return now_; }
-    [[nodiscard]] u64 timestamp_of_next_event() const noexcept { ASSERT(!heap_.empty()); return heap_.front().timestamp; }
-    [[nodiscard]] u32 remaining_cycles_to_next_event() const noexcept { return narrow<u32>(timestamp_of_next_event() - now()); }
+    [[nodiscard]] vector<hw_event> pending_events() const noexcept
+    {
+        vector<hw_event> events;
+        events.reserve(heap_.size() + event_source_count);
+        for(usize idx = 0_usize; idx < event_source_count; ++idx) {
+            if(fixed_timestamps_[idx] != inactive_timestamp) {
+                events.push_back(hw_event{fixed_events_[idx].callback, fixed_timestamps_[idx], fixed_events_[idx].h});
+            }
+        }
+        for(const u32 slot_idx : heap_) {
+            events.push_back(slots_[slot_idx].event);
+        }
+        return events;
+    }
 
     template<typename Ar>
     void serialize(Ar& archive) const noexcept
     {
-        archive.serialize(heap_);
+        const vector<hw_event> events = pending_events();
+        archive.serialize(events.size());
+        for(const hw_event& event : events) {
+            serialize_event(archive, event);
+        }
         archive.serialize(now_);
         archive.serialize(next_event_handle_);
     }
@@ -185,9 +261,245 @@ public:
     template<typename Ar>
     void deserialize(const Ar& archive) noexcept
     {
-        archive.deserialize(heap_);
+        vector<hw_event> events{archive.template deserialize<usize>()};
+        for(hw_event& event : events) {
+            deserialize_event(archive, event);
+        }
         archive.deserialize(now_);
         archive.deserialize(next_event_handle_);
+
+        std::fill(fixed_timestamps_.begin(), fixed_timestamps_.end(), inactive_timestamp);
+        next_timestamp_ = inactive_timestamp;
+
+        vector<hw_event> heap_events;
+        for(const hw_event& event : events) {
+            if(is_fixed(event.h)) {
+                insert_fixed(event);
+            } else {
+                heap_events.push_back(event);
+            }
+        }
+
+        // states might hold handles which share a slot, grow until they don't
+        usize slot_count = initial_slot_count;
+        while(!fits_into_slots(heap_events, slot_count)) {
+            slot_count *= 2_usize;
+        }
+
+        slots_ = vector<slot>{slot_count};
+        slot_mask_ = slot_count.get() - 1_u64;
+        heap_.clear();
+        for(const hw_event& event : heap_events) {
+            insert(event);
+        }
+    }
+
+private:
+    template<typename Ar>
+    void serialize_event(Ar& archive, const hw_event& event) const noexcept
+    {
+        const hw_event_registry::entry* event_entry = event_registry_.find_by_callback(event.callback);
+        if(!event_entry) {
+            LOG_CRITICAL(scheduler, "unencountered event callback");
+            PANIC();
+        }
+
+        archive.serialize(event_entry->name);
+        archive.serialize(event.timestamp);
+        archive.serialize(event.h);
+    }
+
+    template<typename Ar>
+    void deserialize_event(const Ar& archive, hw_event& event) const noexcept
+    {
+        const std::string_view event_name = archive.template deserialize<std::string_view>();
+
+        const hw_event_registry::entry* event_entry = event_registry_.find_by_name(event_name);
+        if(!event_entry) {
+            LOG_CRITICAL(scheduler, "corrupted serialized event data {}", event_name);
+            PANIC();
+        }
+
+        event.callback = event_entry->callback;
+        archive.deserialize(event.timestamp);
+        archive.deserialize(event.h);
+    }
+
+    [[nodiscard]] static bool is_fixed(const hw_event::handle handle) noexcept { return (handle & fixed_handle_bit) != 0_u64; }
+    [[nodiscard]] static usize source_of(const hw_event::handle handle) noexcept { return narrow<usize>(handle & 0xFF_u64); }
+    // scheduling order of an event, fixed and heap handles come from the same counter
+    [[nodiscard]] static u64 sequence_of(const hw_event::handle handle) noexcept
+    {
+        return is_fixed(handle) ? (handle & ~fixed_handle_bit) >> 8_u64 : handle;
+    }
+
+    void insert_fixed(const hw_event& event) noexcept
+    {
+        const usize idx = source_of(event.h);
+        ASSERT(fixed_timestamps_[idx] == inactive_timestamp);
+        fixed_timestamps_[idx] = event.timestamp;
+        fixed_events_[idx] = fixed_event{event.callback, event.h};
+        next_timestamp_ = std::min(next_timestamp_, event.timestamp);
+    }
+
+    void erase_fixed(const usize idx) noexcept
+    {
+        fixed_timestamps_[idx] = inactive_timestamp;
+        update_next_timestamp();
+    }
+
+    void update_next_timestamp() noexcept
+    {
+        u64::type next = heap_.empty() ? inactive_timestamp.get() : slots_[heap_.front()].event.timestamp.get();
+        for(const u64 timestamp : fixed_timestamps_) {
+            next = timestamp.get() < next ? timestamp.get() : next;
+        }
+        next_timestamp_ = next;
+    }
+
+    void fire_next_event() noexcept
+    {
+        // pick the event due at next_timestamp_ which was scheduled first
+        hw_event event{{}, inactive_timestamp, 0_u64};
+        usize fixed_idx = event_source_count;
+        for(usize idx = 0_usize; idx < event_source_count; ++idx) {
+            if(fixed_timestamps_[idx] == next_timestamp_
+              && (fixed_idx == event_source_count || sequence_of(fixed_events_[idx].h) < sequence_of(event.h))) {
+                event = hw_event{fixed_events_[idx].callback, fixed_timestamps_[idx], fixed_events_[idx].h};
+                fixed_idx = idx;
+            }
+        }
+
+        if(!heap_.empty()) {
+            const hw_event& top = slots_[heap_.front()].event;
+            if(top.timestamp == next_timestamp_ && (fixed_idx == event_source_count || sequence_of(top.h) < sequence_of(event.h))) {
+                event = top;
+                fixed_idx = event_source_count;
+            }
+        }
+
+        if(fixed_idx != event_source_count) {
+            erase_fixed(fixed_idx);
+        } else {
+            erase(0_u32);
+        }
+
+        // call with how much cycles the event has been late
+        event.callback(narrow<u32>(now_ - event.timestamp));
+    }
+
+    [[nodiscard]] FORCEINLINE slot& slot_of(const hw_event::handle handle) noexcept { return slots_[narrow<usize>(handle & slot_mask_)]; }
+    [[nodiscard]] FORCEINLINE const slot& slot_of(const hw_event::handle handle) const noexcept { return slots_[narrow<usize>(handle & slot_mask_)]; }
+
+    [[nodiscard]] bool before(const u32 lhs, const u32 rhs) const noexcept
+    {
+        const hw_event& l = slots_[heap_[lhs]].event;
+        const hw_event& r = slots_[heap_[rhs]].event;
+        return l.timestamp < r.timestamp || (l.timestamp == r.timestamp && l.h < r.h);
+    }
+
+    void insert(const hw_event& event) noexcept
+    {
+        slot& s = slot_of(event.h);
+        ASSERT(!s.active);
+        s.event = event;
+        s.active = true;
+        s.heap_index = narrow<u32>(heap_.size());
+
+        heap_.push_back(narrow<u32>(event.h & slot_mask_));
+        sift_up(s.heap_index);
+        next_timestamp_ = std::min(next_timestamp_, event.timestamp);
+    }
+
+    void erase(const u32 heap_index) noexcept
+    {
+        slots_[heap_[heap_index]].active = false;
+
+        const u32 last = narrow<u32>(heap_.size()) - 1_u32;
+        if(heap_index != last) {
+            swap(heap_index, last);
+            heap_.pop_back();
+            sift_down(heap_index);
+            sift_up(heap_index);
+        } else {
+            heap_.pop_back();
+        }
+        update_next_timestamp();
+    }
+
+    void sift_up(u32 heap_index) noexcept
+    {
+        while(heap_index > 0_u32) {
+            const u32 parent = (heap_index - 1_u32) / 2_u32;
+            if(!before(heap_index, parent)) {
+                break;
+            }
+
+            swap(heap_index, parent);
+            heap_index = parent;
+        }
+    }
+
+    void sift_down(u32 heap_index) noexcept
+    {
+        const u32 size = narrow<u32>(heap_.size());
+        while(true) {
+            const u32 left = 2_u32 * heap_index + 1_u32;
+            const u32 right = left + 1_u32;
+
+            u32 smallest = heap_index;
+            if(left < size && before(left, smallest)) {
+                smallest = left;
+            }
+            if(right < size && before(right, smallest)) {
+                smallest = right;
+            }
+
+            if(smallest == heap_index) {
+                break;
+            }
+
+            swap(heap_index, smallest);
+            heap_index = smallest;
+        }
+    }
+
+    void swap(const u32 lhs, const u32 rhs) noexcept
+    {
+        std::swap(heap_[lhs], heap_[rhs]);
+        slots_[heap_[lhs]].heap_index = lhs;
+        slots_[heap_[rhs]].heap_index = rhs;
+    }
+
+    void grow_slots() noexcept
+    {
+        vector<hw_event> events;
+        events.reserve(heap_.size());
+        for(const u32 slot_idx : heap_) {
+            events.push_back(slots_[slot_idx].event);
+        }
+
+        const usize slot_count = slots_.size() * 2_usize;
+
+        slots_ = vector<slot>{slot_count};
+        slot_mask_ = slot_count.get() - 1_u64;
+        heap_.clear();
+        for(const hw_event& event : events) {
+            insert(event);
+        }
+    }
+
+    [[nodiscard]] static bool fits_into_slots(const vector<hw_event>& events, const usize slot_count) noexcept
+    {
+        vector<u8> occupied{slot_count};
+        for(const hw_event& event : events) {
+            const usize idx = narrow<usize>(event.h & (slot_count.get() - 1_u64));
+            if(occupied[idx] != 0_u8) {
+                return false;
+            }
+            occupied[idx] = 1_u8;
+        }
+        return true;
     }
 };
 
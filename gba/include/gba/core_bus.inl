@@ -9,6 +9,8 @@
 #ifndef GAMEBOIADVANCE_CORE_BUS_H
 #define GAMEBOIADVANCE_CORE_BUS_H
 
+#include <cstring>
+
 #include <gba/cpu/bus_interface.h>
 
 namespace gba {
@@ -99,6 +101,94 @@ struct io_traits<u8> {
 
 } // namespace traits
 
+template<typename T>
+T core::read_io_register(const u32 addr) noexcept
+{
+    if constexpr(traits::is_byte_access<T>) {
+        return read_io(addr);
+    } else if constexpr(traits::is_hword_access<T>) {
+        if(const io_register* reg = find_io_register(addr); reg && reg->read_16) {
+            return reg->read_16(this, addr);
+        }
+        return widen<u16>(read_io(addr)) | widen<u16>(read_io(addr + 1_u32)) << 8_u16;
+    } else {
+        if(const io_register* reg = find_io_register(addr); reg && reg->read_32) {
+            return reg->read_32(this, addr);
+        }
+        return widen<u32>(read_io_register<u16>(addr)) | widen<u32>(read_io_register<u16>(addr + 2_u32)) << 16_u32;
+    }
+}
+
+template<typename T>
+void core::write_io_register(const u32 addr, const T data) noexcept
+{
+    if constexpr(traits::is_byte_access<T>) {
+        write_io(addr, data);
+    } else if constexpr(traits::is_hword_access<T>) {
+        if(const io_register* reg = find_io_register(addr); reg && reg->write_16) {
+            reg->write_16(this, addr, data);
+            return;
+        }
+        write_io(addr, narrow<u8>(data));
+        write_io(addr + 1_u32, narrow<u8>(data >> 8_u16));
+    } else {
+        if(const io_register* reg = find_io_register(addr); reg && reg->write_32) {
+            reg->write_32(this, addr, data);
+            return;
+        }
+        write_io_register<u16>(addr, narrow<u16>(data));
+        write_io_register<u16>(addr + 2_u32, narrow<u16>(data >> 16_u32));
+    }
+}
+
+template<typename T>
+void core::tick_access(const u32 addr, const cpu::memory_page page, cpu::mem_access access) noexcept
+{
+    const bool accessing_rom = page >= cpu::memory_page::pak_ws0_lower && page <= cpu::memory_page::pak_ws2_upper;
+    if(accessing_rom) {
+        access = detail::force_nonseq_access(addr, access);
+    }
+
+    const u32 cycles = cpu_.stall_cycles<T>(access, page);
+    if(LIKELY(cpu_.waitcnt_.prefetch_buffer_enable) && accessing_rom) {
+        cpu_.prefetch(addr, cycles);
+    } else {
+        tick_components(cycles);
+    }
+}
+
+template<typename T>
+void core::tick_fetch(const u32 addr, const cpu::mem_access access) noexcept
+{
+#if WITH_DEBUGGER
+    on_io_read(addr, traits::io_traits<T>::debugger_access_width);
+#endif // WITH_DEBUGGER
+
+    tick_access<T>(addr, to_enum<cpu::memory_page>(addr >> 24_u32), access);
+}
+
+template<typename T>
+void core::tick_burst(const u32 addr, const u32 count) noexcept
+{
+    if(count == 0_u32) {
+        return;
+    }
+
+    const auto page = to_enum<cpu::memory_page>(addr >> 24_u32);
+    tick_components(widen<u32>(cpu_.stall_cycles<T>(cpu::mem_access::non_seq, page))
+      + (count - 1_u32) * widen<u32>(cpu_.stall_cycles<T>(cpu::mem_access::seq, page)));
+}
+
+template<typename T>
+u32 core::access_cycles(const u32 addr, cpu::mem_access access) noexcept
+{
+    const auto page = to_enum<cpu::memory_page>(addr >> 24_u32);
+    if(page >= cpu::memory_page::pak_ws0_lower && page <= cpu::memory_page::pak_ws2_upper) {
+        access = detail::force_nonseq_access(addr, access);
+    }
+    return widen<u32>(cpu_.stall_cycles<T>(access, page));
+}
+
 template<typename T>
 T core::read(u32 addr, cpu::mem_access access) noexcept
 {
@@ -108,17 +198,7 @@ T core::read(u32 addr, cpu::mem_access access) noexcept
 
     const auto page = to_enum<cpu::memory_page>(addr >> 24_u32);
     if(LIKELY(access != cpu::mem_access::none)) {
-        const bool accessing_rom = page >= cpu::memory_page::pak_ws0_lower && page <= cpu::memory_page::pak_ws2_upper;
-        if(accessing_rom) {
-            access = detail::force_nonseq_access(addr, access);
-        }
-
-        const u32 cycles = cpu_.stall_cycles<T>(access, page);
-        if(LIKELY(cpu_.waitcnt_.prefetch_buffer_enable) && accessing_rom) {
-            cpu_.prefetch(addr, cycles);
-        } else {
-            tick_components(cycles);
-        }
+        tick_access<T>(addr, page, access);
     }
 
     if constexpr(traits::io_traits<T>::addr_alignment_mask != 0_u32) {
@@ -127,6 +207,12 @@ T core::read(u32 addr, cpu::mem_access access) noexcept
         }
     }
 
+    if(const u8* host = cpu_.page_table_.read_ptr(addr); LIKELY(host != nullptr)) {
+        T data;
+        std::memcpy(&data, host, sizeof(T));
+        return data;
+    }
+
     switch(page) {
         case cpu::memory_page::bios:
             return narrow<T>(cpu_.read_bios(addr));
@@ -134,13 +220,9 @@ T core::read(u32 addr, cpu::mem_access access) noexcept
             return memcpy<T>(cpu_.wram_, addr & 0x0003'FFFF_u32);
         case cpu::memory_page::iwram:
             return memcpy<T>(cpu_.iwram_, addr & 0x0000'7FFF_u32);
-        case cpu::memory_page::io: {
-            u32 io_val;
-            for(u32 idx = 0_u32; idx < sizeof(T); ++idx) {
-                io_val |= widen<u32>(read_io(addr + idx)) << (8_u32 * idx);
-            }
-            return narrow<T>(io_val);
-        }
+        case cpu::memory_page::io:
+            sync_cycles();
+            return read_io_register<T>(addr);
         case cpu::memory_page::palette_ram:
             return memcpy<T>(ppu_engine_.palette_ram_, addr & 0x0000'03FF_u32);
         case cpu::memory_page::vram:
@@ -148,7 +230,7 @@ T core::read(u32 addr, cpu::mem_access access) noexcept
         case cpu::memory_page::oam_ram:
             return memcpy<T>(ppu_engine_.oam_, addr & 0x0000'03FF_u32);
         case cpu::memory_page::pak_ws2_upper:
-            if(UNLIKELY(detail::is_eeprom(gamepak_.pak_data_.size(), gamepak_.backup_type(), addr))) {
+            if(UNLIKELY(detail::is_eeprom(gamepak_.pak_data_->size(), gamepak_.backup_type(), addr))) {
                 if constexpr(traits::is_word_access<T>) {
                     return widen<u32>(gamepak_.backup_->read(addr))
                       | widen<u32>(gamepak_.backup_->read(addr)) << 16_u32;
@@ -170,7 +252,7 @@ T core::read(u32 addr, cpu::mem_access access) noexcept
                 }
             }
 
-            if(UNLIKELY(addr >= gamepak_.pak_data_.size())) {
+            if(UNLIKELY(addr >= gamepak_.pak_data_->size())) {
                 if constexpr(traits::is_word_access<T>) {
                     const u32 fill_addr = (addr >> 1_u32) & 0xFFFF_u32;
                     return ((fill_addr + 1_u32) << 16_u32) | fill_addr;
@@ -181,7 +263,7 @@ T core::read(u32 addr, cpu::mem_access access) noexcept
                 }
             }
 
-            return memcpy<T>(gamepak_.pak_data_, addr);
+            return memcpy<T>(*gamepak_.pak_data_, addr);
         case cpu::memory_page::pak_sram_1: case cpu::memory_page::pak_sram_2: {
             if(cpu_.prefetch_buffer_.active) {
                 cpu_.prefetch_buffer_.active = false;
@@ -211,17 +293,7 @@ void core::write(u32 addr, const T data, cpu::mem_access access) noexcept
     const auto page = to_enum<cpu::memory_page>(addr >> 24_u32);
 
     ASSERT(access != cpu::mem_access::none);
-    const bool accessing_rom = page >= cpu::memory_page::pak_ws0_lower && page <= cpu::memory_page::pak_ws2_upper;
-    if(accessing_rom) {
-        access = detail::force_nonseq_access(addr, access);
-    }
-
-    const u32 cycles = cpu_.stall_cycles<T>(access, page);
-    if(LIKELY(cpu_.waitcnt_.prefetch_buffer_enable) && accessing_rom) {
-        cpu_.prefetch(addr, cycles);
-    } else {
-        tick_components(cycles);
-    }
+    tick_access<T>(addr, page, access);
 
     if constexpr(traits::io_traits<T>::addr_alignment_mask != 0_u32) {
         if(LIKELY(page != cpu::memory_page::pak_sram_1 && page != cpu::memory_page::pak_sram_2)) {
@@ -229,6 +301,13 @@ void core::write(u32 addr, const T data, cpu::mem_access access) noexcept
         }
     }
 
+    // byte writes to video memory are special cased below
+    const bool plain_write = !traits::is_byte_access<T> || page == cpu::memory_page::ewram || page == cpu::memory_page::iwram;
+    if(u8* host = cpu_.page_table_.write_ptr(addr); LIKELY(host != nullptr && plain_write)) {
+        std::memcpy(host, &data, sizeof(T));
+        return;
+    }
+
     switch(page) {
         case cpu::memory_page::ewram:
             memcpy<T>(cpu_.wram_, addr & 0x0003'FFFF_u32, data);
@@ -237,9 +316,9 @@ void core::write(u32 addr, const T data, cpu::mem_access access) noexcept
             memcpy<T>(cpu_.iwram_, addr & 0x0000'7FFF_u32, data);
             break;
         case cpu::memory_page::io:
-            for(u32 idx = 0_u32; idx < sizeof(T); ++idx) {
-                write_io(addr + idx, narrow<u8>(data >> (8_u32 * idx)));
-            }
+            sync_cycles();
+            write_io_register<T>(addr, data);
+            sync_cycles();
             break;
         case cpu::memory_page::palette_ram:
             if constexpr(traits::is_byte_access<T>) {
@@ -247,25 +326,29 @@ void core::write(u32 addr, const T data, cpu::mem_access access) noexcept
             } else {
                 memcpy<T>(ppu_engine_.palette_ram_, addr & 0x0000'03FF_u32, data);
             }
+            ppu_engine_.on_palette_write(addr & 0x0000'03FF_u32, usize{sizeof(T)});
             break;
         case cpu::memory_page::vram:
             if constexpr(traits::is_byte_access<T>) {
                 const u32 limit = ppu_engine_.dispcnt_.bg_mode > 2 ? 0x1'4000_u32 : 0x1'0000_u32;
                 if(const u32 adjusted_addr = detail::adjust_vram_addr(addr); adjusted_addr < limit) {
                     memcpy<u16>(ppu_engine_.vram_, bit::clear(adjusted_addr, 0_u8), data * 0x0101_u16);
+                    ppu_engine_.on_vram_write(adjusted_addr, 1_usize);
                 }
             } else {
                 memcpy<T>(ppu_engine_.vram_, detail::adjust_vram_addr(addr), data);
+                ppu_engine_.on_vram_write(detail::adjust_vram_addr(addr), usize{sizeof(T)});
             }
             break;
         case cpu::memory_page::oam_ram:
             if constexpr(!traits::is_byte_access<T>) {
                 memcpy<T>(ppu_engine_.oam_, addr & 0x0000'03FF_u32, data);
+                ppu_engine_.on_oam_write(addr & 0x0000'03FF_u32, usize{sizeof(T)});
             }
             break;
         case cpu::memory_page::pak_ws2_upper:
             if constexpr(traits::is_hword_access<T>) {
-                const bool is_eeprom = detail::is_eeprom(gamepak_.pak_data_.size(), gamepak_.backup_type(), addr);
+                const bool is_eeprom = detail::is_eeprom(gamepak_.pak_data_->size(), gamepak_.backup_type(), addr);
                 if(UNLIKELY(is_eeprom)) {
                     if(cpu_.dma_controller_.is_running()) {
                         if(UNLIKELY(gamepak_.backup_type() == cartridge::backup::type::eeprom_undetected)) {
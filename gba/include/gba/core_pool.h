@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#ifndef GAMEBOIADVANCE_CORE_POOL_H
+#define GAMEBOIADVANCE_CORE_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <gba/core.h>
+
+namespace gba {
+
+/*
+ * Steps many independent cores in parallel. Every run hands out one work item per core,
+ * dealt round-robin into per-worker queues. A worker drains its own queue from the front
+ * and steals from the back of the others' when it runs dry, so slow games do not leave
+ * the other threads idle. Cores share no state, each one is only ever touched by one thread at a time.
+ */
+class core_pool {
+    struct work_queue {
+        std::mutex mutex;
+        std::deque<usize> items;
+    };
+
+    vector<std::unique_ptr<core>> cores_;
+    vector<std::unique_ptr<work_queue>> queues_;
+    vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable work_done_;
+    u64 generation_;
+    u32 frames_per_run_;
+    bool stopping_ = false;
+    std::atomic<usize::type> pending_{0};
+
+public:
+    // zero picks the hardware concurrency
+    explicit core_pool(usize thread_count = 0_usize);
+    ~core_pool();
+
+    core_pool(const core_pool&) = delete;
+    core_pool(core_pool&&) = delete;
+    core_pool& operator=(const core_pool&) = delete;
+    core_pool& operator=(core_pool&&) = delete;
+
+    // must not be called while a run is in progress
+    core& add(vector<u8> bios);
+
+    [[nodiscard]] usize size() const noexcept { return cores_.size(); }
+    [[nodiscard]] usize thread_count() const noexcept { return workers_.size(); }
+    [[nodiscard]] core& operator[](const usize idx) noexcept { return *cores_[idx]; }
+    [[nodiscard]] const core& operator[](const usize idx) const noexcept { return *cores_[idx]; }
+
+    // ticks every core frame_count frames, returns when all of them are done
+    void tick_frames(u32 frame_count);
+    void tick_one_frame() { tick_frames(1_u32); }
+
+private:
+    void worker_loop(usize worker_idx);
+    void drain(usize worker_idx);
+    [[nodiscard]] std::optional<usize> pop(usize worker_idx);
+    [[nodiscard]] std::optional<usize> steal(usize worker_idx);
+};
+
+} // namespace gba
+
+#endif //GAMEBOIADVANCE_CORE_POOL_H
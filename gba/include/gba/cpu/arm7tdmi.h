@@ -8,8 +8,11 @@
 #ifndef GAMEBOIADVANCE_ARM7TDMI_H
 #define GAMEBOIADVANCE_ARM7TDMI_H
 
+#include <cstring>
+
 #include <gba/cpu/bus_interface.h>
 #include <gba/cpu/irq_controller_handle.h>
+#include <gba/cpu/page_table.h>
 #include <gba/core/container.h>
 #include <gba/core/fwd.h>
 #include <gba/core/math.h>
@@ -48,26 +51,113 @@ enum class privilege_mode : u8::type {
     }
 }
 
+/*
+ * Condition flags are not evaluated by the instructions which set them. N and Z are kept
+ * as the value they are derived from, C and V as the operands of the last add or sub.
+ * They are evaluated only when something reads them, like condition checks, psr transfers,
+ * carry inputs and mode switches.
+ */
 struct psr {
-    bool n = false;  // signed flag
-    bool z = false;  // zero flag
-    bool c = false;  // carry flag
-    bool v = false;  // overflow flag
+    enum class flag_op : u8::type { none, add, sub };
+
     bool i = false;  // irq disabled flag
     bool f = false;  // fiq disabled flag
     bool t = false;  // thumb mode flag
     privilege_mode mode{privilege_mode::svc};
 
+private:
+    u32 n_source_;           // signed flag is bit 31 of this
+    u32 z_source_ = 1_u32;   // zero flag is set when this is zero
+    flag_op cv_op_ = flag_op::none;
+    bool c_ = false;         // carry flag when cv_op_ is none, carry input of the add or sub otherwise
+    bool v_ = false;         // overflow flag when cv_op_ is none
+    u32 cv_first_op_;
+    u32 cv_second_op_;
+
+public:
+    [[nodiscard]] FORCEINLINE constexpr bool n() const noexcept { return bit::test(n_source_, 31_u8); }
+    [[nodiscard]] FORCEINLINE constexpr bool z() const noexcept { return z_source_ == 0_u32; }
+
+    [[nodiscard]] FORCEINLINE constexpr bool c() const noexcept
+    {
+        switch(cv_op_) {
+            case flag_op::add:
+                return bit::test(widen<u64>(cv_first_op_) + cv_second_op_ + bit::from_bool(c_), 32_u8);
+            case flag_op::sub:
+                return cv_first_op_ >= widen<u64>(cv_second_op_) + bit::from_bool(!c_);
+            default:
+                return c_;
+        }
+    }
+
+    [[nodiscard]] FORCEINLINE constexpr bool v() const noexcept
+    {
+        switch(cv_op_) {
+            case flag_op::add: {
+                const u32 result = cv_first_op_ + cv_second_op_ + bit::from_bool(c_);
+                return bit::test(~(cv_first_op_ ^ cv_second_op_) & (cv_second_op_ ^ result), 31_u8);
+            }
+            case flag_op::sub: {
+                const u32 result = cv_first_op_ - cv_second_op_ - bit::from_bool(!c_);
+                return bit::test((cv_first_op_ ^ cv_second_op_) & (cv_first_op_ ^ result), 31_u8);
+            }
+            default:
+                return v_;
+        }
+    }
+
+    FORCEINLINE constexpr void set_nz(const u32 result) noexcept
+    {
+        n_source_ = result;
+        z_source_ = result;
+    }
+
+    // for results wider than 32 bits
+    FORCEINLINE constexpr void set_nz(const u32 n_source, const u32 z_source) noexcept
+    {
+        n_source_ = n_source;
+        z_source_ = z_source;
+    }
+
+    FORCEINLINE constexpr void set_c(const bool carry) noexcept
+    {
+        if(cv_op_ != flag_op::none) {
+            v_ = v();
+            cv_op_ = flag_op::none;
+        }
+        c_ = carry;
+    }
+
+    // result = first_op + second_op + carry_in
+    FORCEINLINE constexpr void set_add(const u32 first_op, const u32 second_op, const bool carry_in, const u32 result) noexcept
+    {
+        set_nz(result);
+        cv_op_ = flag_op::add;
+        cv_first_op_ = first_op;
+        cv_second_op_ = second_op;
+        c_ = carry_in;
+    }
+
+    // result = first_op - second_op - !carry_in
+    FORCEINLINE constexpr void set_sub(const u32 first_op, const u32 second_op, const bool carry_in, const u32 result) noexcept
+    {
+        set_nz(result);
+        cv_op_ = flag_op::sub;
+        cv_first_op_ = first_op;
+        cv_second_op_ = second_op;
+        c_ = carry_in;
+    }
+
     constexpr explicit operator u32() const noexcept
     {
         return from_enum<u32>(mode)
           | bit::from_bool(t) << 5_u32
           | bit::from_bool(f) << 6_u32
           | bit::from_bool(i) << 7_u32
-          | bit::from_bool(v) << 28_u32
-          | bit::from_bool(c) << 29_u32
-          | bit::from_bool(z) << 30_u32
-          | bit::from_bool(n) << 31_u32;
+          | bit::from_bool(v()) << 28_u32
+          | bit::from_bool(c()) << 29_u32
+          | bit::from_bool(z()) << 30_u32
+          | bit::from_bool(n()) << 31_u32;
     }
 
     constexpr psr& operator=(const psr&) = default;
@@ -84,10 +174,13 @@ struct psr {
         f = other.f;
         i = other.i;
 
-        v = other.v;
-        c = other.c;
-        z = other.z;
-        n = other.n;
+        n_source_ = other.n_source_;
+        z_source_ = other.z_source_;
+        cv_op_ = other.cv_op_;
+        c_ = other.c_;
+        v_ = other.v_;
+        cv_first_op_ = other.cv_first_op_;
+        cv_second_op_ = other.cv_second_op_;
     }
 
     constexpr void copy_without_mode(const u32 data) noexcept
@@ -96,10 +189,11 @@ struct psr {
         f = bit::test(data, 6_u8);
         i = bit::test(data, 7_u8);
 
-        v = bit::test(data, 28_u8);
-        c = bit::test(data, 29_u8);
-        z = bit::test(data, 30_u8);
-        n = bit::test(data, 31_u8);
+        n_source_ = data;
+        z_source_ = bit::from_bool(!bit::test(data, 30_u8));
+        cv_op_ = flag_op::none;
+        c_ = bit::test(data, 29_u8);
+        v_ = bit::test(data, 28_u8);
     }
 };
 
@@ -140,6 +234,29 @@ struct pipeline {
     u32 decoding;
 };
 
+/*
+ * Tracks the last short backwards branch taken. The loop is idle when its body can not write anything
+ * and one whole iteration ended up with the exact register state it started with.
+ * Nothing in that loop can change until a scheduled event fires, so the cycles until then can be skipped.
+ */
+struct idle_loop_detector {
+    static constexpr u32 max_body_size = 32_u32;
+
+    array<u32, 15> regs{};
+    u32 cpsr;
+    u32 branch_addr;
+    u32 flush_count;
+    u32 tracked_flush_count;
+    bool body_idle = false;
+    bool volatile_read = false;
+    bool detected = false;
+};
+
+struct idle_loop_stats {
+    u64 skipped_cycles;
+    u64 skip_count;
+};
+
 class arm7tdmi {
     friend class decoder_table_generator;
 
@@ -161,6 +278,17 @@ protected:
     scheduler::hw_event::handle irq_signal_delay_handle_;
 
     pipeline pipeline_;
+    page_table page_table_;
+
+    idle_loop_detector idle_loop_;
+    idle_loop_stats idle_loop_stats_;
+    bool idle_loop_skipping_ = false;
+    u64 executed_instructions_;
+
+    // swis are executed natively instead of running bios code
+    bool hle_bios_ = false;
+    // memory heavy swis are executed natively even with a real bios
+    bool native_swi_fast_paths_ = false;
 
 public:
 #if WITH_DEBUGGER
@@ -169,6 +297,9 @@ public:
 
     arm7tdmi(bus_interface* bus, scheduler* scheduler) noexcept;
 
+    // minimal bios image for hle, contains only exception vectors, irq dispatcher and IntrWait
+    [[nodiscard]] static vector<u8> make_hle_bios() noexcept;
+
     void execute_instruction() noexcept;
 
     FORCEINLINE void request_interrupt(const interrupt_source irq) noexcept
@@ -179,6 +310,18 @@ public:
 
     irq_controller_handle get_interrupt_handle() noexcept { return irq_controller_handle{this}; }
 
+    void set_native_swi_fast_paths(const bool enabled) noexcept { native_swi_fast_paths_ = enabled; }
+
+    void set_idle_loop_skipping(const bool enabled) noexcept { idle_loop_skipping_ = enabled; idle_loop_.branch_addr = 0_u32; }
+    [[nodiscard]] const idle_loop_stats& get_idle_loop_stats() const noexcept { return idle_loop_stats_; }
+    void reset_idle_loop_stats() noexcept { idle_loop_stats_ = idle_loop_stats{}; }
+
+    // instructions executed since construction, including the ones which failed their condition
+    [[nodiscard]] u64 executed_instruction_count() const noexcept { return executed_instructions_; }
+
+    // values which change without any scheduled event were read, current iteration can not be idle
+    FORCEINLINE void mark_volatile_read() noexcept { idle_loop_.volatile_read = true; }
+
 private:
     [[nodiscard]] u32 read_32_aligned(u32 addr, mem_access access) noexcept;
     [[nodiscard]] u32 read_16_signed(u32 addr, mem_access access) noexcept;
@@ -188,6 +331,18 @@ private:
     void update_irq_signal(u32 /*late_cycles*/) noexcept { irq_signal_ = scheduled_irq_signal_; }
     void process_interrupts() noexcept;
 
+    // called by branches before the pipeline is flushed, pc() already points to the branch target
+    template<instruction_mode Mode>
+    FORCEINLINE void check_idle_loop(const u32 branch_addr) noexcept
+    {
+        if(idle_loop_skipping_ && pc() <= branch_addr && branch_addr - pc() <= idle_loop_detector::max_body_size) {
+            track_idle_loop(branch_addr, Mode == instruction_mode::thumb);
+        }
+    }
+
+    void track_idle_loop(u32 branch_addr, bool thumb) noexcept;
+    [[nodiscard]] bool is_idle_loop_body(u32 begin, u32 end, bool thumb) noexcept;
+
     // ARM instructions
     enum class arm_alu_opcode { and_, eor, sub, rsb, add, adc, sbc, rsc, tst, teq, cmp, cmn, orr, mov, bic, mvn };
     enum class psr_transfer_opcode { mrs, msr };
@@ -262,6 +417,35 @@ private:
     template<bool IsSecondIntruction>
     void long_branch_link(u16 instr) noexcept;
 
+    // hle bios, returns false if the swi must enter the bios, otherwise execution continues past the swi
+    [[nodiscard]] FORCEINLINE bool should_execute_natively(const u8 number) const noexcept
+    {
+        // CpuSet, CpuFastSet and the decompression functions
+        return hle_bios_ || (native_swi_fast_paths_ && (number == 0x0B_u8 || number == 0x0C_u8
+          || (number >= 0x11_u8 && number <= 0x15_u8)));
+    }
+    bool execute_hle_swi(u8 number) noexcept;
+    void hle_soft_reset() noexcept;
+    void hle_register_ram_reset() noexcept;
+    void hle_div(i32 numerator, i32 denominator) noexcept;
+    void hle_sqrt() noexcept;
+    void hle_cpu_set() noexcept;
+    void hle_cpu_fast_set() noexcept;
+    template<typename T>
+    void hle_transfer(u32 src, u32 dst, u32 count, bool fill) noexcept;
+    void hle_bg_affine_set() noexcept;
+    void hle_obj_affine_set() noexcept;
+    void hle_sound_bias() noexcept;
+    void hle_midi_key_to_freq() noexcept;
+    [[nodiscard]] vector<u8> hle_bit_unpack() noexcept;
+    template<typename T>
+    [[nodiscard]] vector<u8> hle_diff_unfilter() noexcept;
+    [[nodiscard]] vector<u8> hle_lz77_uncomp() noexcept;
+    [[nodiscard]] vector<u8> hle_rl_uncomp() noexcept;
+    [[nodiscard]] vector<u8> hle_huff_uncomp() noexcept;
+    template<typename T>
+    void hle_write_uncompressed(const vector<u8>& data) noexcept;
+
     // decoder helpers
     [[nodiscard]] bool condition_met(u32 cond) const noexcept;
 
@@ -297,17 +481,41 @@ protected:
     void schedule_update_irq_signal() noexcept;
 
 private:
+    // opcode fetches from plain memory only go through the bus for timing
+    FORCEINLINE u32 fetch_32(const u32 addr, const mem_access access) noexcept
+    {
+        if(const u8* host = page_table_.read_ptr(mask::clear(addr, 0b11_u32))) {
+            bus_->tick_fetch_32(addr, access);
+            u32 instr;
+            std::memcpy(&instr, host, sizeof(instr));
+            return instr;
+        }
+        return bus_->read_32(addr, access);
+    }
+
+    FORCEINLINE u16 fetch_16(const u32 addr, const mem_access access) noexcept
+    {
+        if(const u8* host = page_table_.read_ptr(bit::clear(addr, 0_u8))) {
+            bus_->tick_fetch_16(addr, access);
+            u16 instr;
+            std::memcpy(&instr, host, sizeof(instr));
+            return instr;
+        }
+        return bus_->read_16(addr, access);
+    }
+
     template<instruction_mode Mode>
     void pipeline_flush() noexcept
     {
+        ++idle_loop_.flush_count;
         if constexpr(Mode == instruction_mode::arm) {
-            pipeline_.executing = bus_->read_32(pc(), mem_access::non_seq);
-            pipeline_.decoding = bus_->read_32(pc() + 4_u32, mem_access::seq);
+            pipeline_.executing = fetch_32(pc(), mem_access::non_seq);
+            pipeline_.decoding = fetch_32(pc() + 4_u32, mem_access::seq);
             pipeline_.fetch_type = mem_access::seq;
             pc() += 8_u32;
         } else {
-            pipeline_.executing = bus_->read_16(pc(), mem_access::non_seq);
-            pipeline_.decoding = bus_->read_16(pc() + 2_u32, mem_access::seq);
+            pipeline_.executing = fetch_16(pc(), mem_access::non_seq);
+            pipeline_.decoding = fetch_16(pc() + 2_u32, mem_access::seq);
             pipeline_.fetch_type = mem_access::seq;
             pc() += 4_u32;
         }
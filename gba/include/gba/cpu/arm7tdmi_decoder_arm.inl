@@ -38,11 +38,15 @@ inline void arm7tdmi::branch_exchange(const u32 instr) noexcept
 template<bool WithLink>
 void arm7tdmi::branch_with_link(const u32 instr) noexcept
 {
+    const u32 branch_addr = pc() - 8_u32;
     if constexpr(WithLink) {
         lr() = pc() - 4_u32;
     }
 
     pc() += math::sign_extend<26>((instr & 0x00FF'FFFF_u32) << 2_u32);
+    if constexpr(!WithLink) {
+        check_idle_loop<instruction_mode::arm>(branch_addr);
+    }
     pipeline_flush<instruction_mode::arm>();
 }
 
@@ -53,7 +57,9 @@ void arm7tdmi::data_processing(const u32 instr) noexcept
     constexpr auto shift_type = to_enum<barrel_shift_type>((op2 >> 1_u32) & 0b11_u32);
     constexpr bool shift_by_imm = !bit::test(op2, 0_u8);
 
-    bool carry = cpsr().c;
+    // carry input matters only to logical ops which set flags and to rrx
+    constexpr bool needs_carry = ShouldSetCond || (!HasImmediateOp2 && shift_type == barrel_shift_type::ror);
+    bool carry = needs_carry && cpsr().c();
     const u32 rn = (instr >> 16_u8) & 0xF_u8;
     u32 first_op;
     u32 second_op;
@@ -89,9 +95,8 @@ void arm7tdmi::data_processing(const u32 instr) noexcept
     u32& rd = r_[dest];
 
     const auto do_set_flags = [&](const u32 expression) {
-        cpsr().n = bit::test(expression, 31_u8);
-        cpsr().z = expression == 0_u32;
-        cpsr().c = carry;
+        cpsr().set_nz(expression);
+        cpsr().set_c(carry);
     };
 
     const auto evaluate_and_set_flags = [&](const u32 expression) {
@@ -261,8 +266,7 @@ void arm7tdmi::multiply(const u32 instr) noexcept
     }
 
     if constexpr(ShouldSetCond) {
-        cpsr().z = result == 0_u32;
-        cpsr().n = bit::test(result, 31_u8);
+        cpsr().set_nz(result);
     }
 
     rd = result;
@@ -309,13 +313,12 @@ void arm7tdmi::multiply_long(const u32 instr) noexcept
         bus_->idle();
     }
 
-    if constexpr(ShouldSetCond) {
-        cpsr().z = result == 0_i64;
-        cpsr().n = result < 0_i64;
-    }
-
     rdhi = narrow<u32>(make_unsigned(result) >> 32_u64);
     rdlo = narrow<u32>(make_unsigned(result));
+
+    if constexpr(ShouldSetCond) {
+        cpsr().set_nz(rdhi, rdhi | rdlo);
+    }
 }
 
 template<bool HasImmediateOffset, bool HasPreIndexing,
@@ -335,7 +338,7 @@ void arm7tdmi::single_data_transfer(const u32 instr) noexcept
             const auto shift_type = static_cast<barrel_shift_type>(((instr >> 5_u32) & 0b11_u32).get());
             const u8 shift_amount = narrow<u8>((instr >> 7_u32) & 0x1F_u32);
             u32 rm = r_[instr & 0xF_u32];
-            bool dummy = cpsr().c;
+            bool dummy = cpsr().c();
             alu_barrel_shift(shift_type, rm, shift_amount, dummy, true);
             return rm;
         }
@@ -591,8 +594,12 @@ void arm7tdmi::single_data_swap(const u32 instr) noexcept
     }
 }
 
-inline void arm7tdmi::swi_arm(const u32 /*instr*/) noexcept
+inline void arm7tdmi::swi_arm(const u32 instr) noexcept
 {
+    if(const u8 number = narrow<u8>(instr >> 16_u32); should_execute_natively(number) && execute_hle_swi(number)) {
+        return;
+    }
+
     spsr_banks_[register_bank::svc] = cpsr();
     switch_mode(privilege_mode::svc);
     cpsr().i = true;
@@ -16,14 +16,15 @@ void arm7tdmi::move_shifted_reg(const u16 instr) noexcept
     const u8 offset = narrow<u8>((instr >> 6_u16) & 0x1F_u16);
     u32 rs = r_[(instr >> 3_u16) & 0x7_u16];
     u32& rd = r_[instr & 0x7_u16];
-    bool carry = cpsr().c;
+    bool carry = false;
 
     alu_barrel_shift(static_cast<barrel_shift_type>(OpCode), rs, offset, carry, true);
     rd = rs;
 
-    cpsr().z = rs == 0_u32;
-    cpsr().n = bit::test(rs, 31_u8);
-    cpsr().c = carry;
+    cpsr().set_nz(rs);
+    if(OpCode != move_shifted_reg_opcode::lsl || offset != 0_u8) { // lsl #0 keeps the carry
+        cpsr().set_c(carry);
+    }
 
     pipeline_.fetch_type = mem_access::seq;
     pc() += 2_u32;
@@ -53,8 +54,7 @@ void arm7tdmi::mov_cmp_add_sub_imm(const u16 instr) noexcept
     switch(OpCode) {
         case imm_op_opcode::mov:
             r_[Rd] = offset;
-            cpsr().n = false;
-            cpsr().z = offset == 0_u16;
+            cpsr().set_nz(r_[Rd]);
             break;
         case imm_op_opcode::cmp:
             alu_sub(r_[Rd], offset, true);
@@ -78,14 +78,12 @@ void arm7tdmi::alu(const u16 instr) noexcept
 {
     u32 rs = r_[(instr >> 3_u16) & 0x7_u16];
     u32& rd = r_[instr & 0x7_u16];
-    bool carry = cpsr().c;
 
     pipeline_.fetch_type = mem_access::seq;
     pc() += 2_u32;
 
     const auto evaluate_and_set_flags = [&](const u32 expression) {
-        cpsr().n = bit::test(expression, 31_u8);
-        cpsr().z = expression == 0_u32;
+        cpsr().set_nz(expression);
         return expression;
     };
 
@@ -96,44 +94,52 @@ void arm7tdmi::alu(const u16 instr) noexcept
         case thumb_alu_opcode::eor:
             rd = evaluate_and_set_flags(rd ^ rs);
             break;
-        case thumb_alu_opcode::lsl:
+        case thumb_alu_opcode::lsl: {
+            bool carry = cpsr().c();
             alu_lsl(rd, narrow<u8>(rs), carry);
             rd = evaluate_and_set_flags(rd);
-            cpsr().c = carry;
+            cpsr().set_c(carry);
 
             bus_->idle();
             pipeline_.fetch_type = mem_access::non_seq;
             break;
-        case thumb_alu_opcode::lsr:
+        }
+        case thumb_alu_opcode::lsr: {
+            bool carry = cpsr().c();
             alu_lsr(rd, narrow<u8>(rs), carry, false);
             rd = evaluate_and_set_flags(rd);
-            cpsr().c = carry;
+            cpsr().set_c(carry);
 
             bus_->idle();
             pipeline_.fetch_type = mem_access::non_seq;
             break;
-        case thumb_alu_opcode::asr:
+        }
+        case thumb_alu_opcode::asr: {
+            bool carry = cpsr().c();
             alu_asr(rd, narrow<u8>(rs), carry, false);
             rd = evaluate_and_set_flags(rd);
-            cpsr().c = carry;
+            cpsr().set_c(carry);
 
             bus_->idle();
             pipeline_.fetch_type = mem_access::non_seq;
             break;
+        }
         case thumb_alu_opcode::adc:
             rd = alu_adc(rd, rs, true);
             break;
         case thumb_alu_opcode::sbc:
             rd = alu_sbc(rd, rs, true);
             break;
-        case thumb_alu_opcode::ror:
+        case thumb_alu_opcode::ror: {
+            bool carry = cpsr().c();
             alu_ror(rd, narrow<u8>(rs), carry, false);
             rd = evaluate_and_set_flags(rd);
-            cpsr().c = carry;
+            cpsr().set_c(carry);
 
             bus_->idle();
             pipeline_.fetch_type = mem_access::non_seq;
             break;
+        }
         case thumb_alu_opcode::tst:
             evaluate_and_set_flags(rd & rs);
             break;
@@ -154,7 +160,7 @@ void arm7tdmi::alu(const u16 instr) noexcept
                 return r == 0_u32 || r == mask;
             });
             rd = evaluate_and_set_flags(rd * rs);
-            cpsr().c = false;
+            cpsr().set_c(false);
             pipeline_.fetch_type = mem_access::non_seq;
             break;
         case thumb_alu_opcode::bic:
@@ -513,7 +519,9 @@ void arm7tdmi::branch_cond(const u16 instr) noexcept
 {
     if(condition_met(Condition)) {
         const i32 offset = math::sign_extend<9>(widen<u32>((instr & 0xFF_u16)) << 1_u32);
+        const u32 branch_addr = pc() - 4_u32;
         pc() += offset;
+        check_idle_loop<instruction_mode::thumb>(branch_addr);
         pipeline_flush<instruction_mode::thumb>();
     } else {
         pipeline_.fetch_type = mem_access::seq;
@@ -521,8 +529,12 @@ void arm7tdmi::branch_cond(const u16 instr) noexcept
     }
 }
 
-inline void arm7tdmi::swi_thumb(const u16 /*instr*/) noexcept
+inline void arm7tdmi::swi_thumb(const u16 instr) noexcept
 {
+    if(const u8 number = narrow<u8>(instr); should_execute_natively(number) && execute_hle_swi(number)) {
+        return;
+    }
+
     spsr_banks_[register_bank::svc] = cpsr();
     switch_mode(privilege_mode::svc);
     cpsr().i = true;
@@ -535,7 +547,9 @@ inline void arm7tdmi::swi_thumb(const u16 /*instr*/) noexcept
 inline void arm7tdmi::branch(const u16 instr) noexcept
 {
     const i32 offset = math::sign_extend<12>(widen<u32>((instr & 0x7FF_u16)) << 1_u32);
+    const u32 branch_addr = pc() - 4_u32;
     pc() += offset;
+    check_idle_loop<instruction_mode::thumb>(branch_addr);
     pipeline_flush<instruction_mode::thumb>();
 }
 
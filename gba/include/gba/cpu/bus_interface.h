@@ -9,6 +9,7 @@
 #ifndef GAMEBOIADVANCE_MEMORY_BUS_INTERFACE_H
 #define GAMEBOIADVANCE_MEMORY_BUS_INTERFACE_H
 
+#include <gba/core/container.h>
 #include <gba/core/integer.h>
 #include <gba/helper/bitflags.h>
 
@@ -36,8 +37,29 @@ struct bus_interface {
     virtual u8 read_8(u32 addr, mem_access access) noexcept = 0;
     virtual void write_8(u32 addr, u8 data, mem_access access) noexcept = 0;
 
+    // charges the cycles of an opcode fetch whose data is already known
+    virtual void tick_fetch_32(u32 addr, mem_access access) noexcept = 0;
+    virtual void tick_fetch_16(u32 addr, mem_access access) noexcept = 0;
+
+    // charges the cycles of a non sequential access followed by count - 1 sequential ones
+    virtual void tick_burst_32(u32 addr, u32 count) noexcept = 0;
+    virtual void tick_burst_16(u32 addr, u32 count) noexcept = 0;
+
+    // cycles a single access would stall for, nothing is charged
+    virtual u32 access_cycles_32(u32 addr, mem_access access) noexcept = 0;
+    virtual u32 access_cycles_16(u32 addr, mem_access access) noexcept = 0;
+
+    // plain memory from addr to the end of its region, empty if reads have side effects
+    virtual view<u8> readable_memory(u32 addr) noexcept = 0;
+    // plain memory backing [addr, addr + size), nullptr if writes have side effects or the range wraps
+    virtual u8* writable_memory(u32 addr, usize size) noexcept = 0;
+    // pushes samples straight into the sound fifo at addr, nothing is charged
+    virtual void write_sound_fifo(u32 addr, view<u8> samples) noexcept = 0;
+
     virtual void tick_components(u32 cycles) noexcept = 0;
     virtual void idle() noexcept = 0;
+    // cycles that can be charged before the next event has to fire
+    virtual u32 cycles_to_next_event() noexcept = 0;
 };
 
 } // namespace gba::cpu
@@ -98,6 +98,8 @@ class cpu : public arm7tdmi {
       stall_table_entry{1_u8, 1_u8, 6_u8, 1_u8, 1_u8, 2_u8, 2_u8, 1_u8, 0_u8, 0_u8, 0_u8, 0_u8, 0_u8, 0_u8, 0_u8, 1_u8},
       stall_table_entry{1_u8, 1_u8, 6_u8, 1_u8, 1_u8, 2_u8, 2_u8, 1_u8, 0_u8, 0_u8, 0_u8, 0_u8, 0_u8, 0_u8, 0_u8, 1_u8}
     };
+    // returned by reference as the other entries, kept per instance so that no core writes into shared state
+    u8 unused_area_cycles_ = 1_u8;
 
     halt_control haltcnt_{halt_control::running};
 
@@ -108,8 +110,18 @@ public:
         dma_controller_{bus, get_interrupt_handle(), scheduler},
         timer_controller_{scheduler, get_interrupt_handle()}
     {
+        if(bios_.empty()) {
+            LOG_INFO(cpu, "no bios provided, using hle bios");
+            bios_ = make_hle_bios();
+            hle_bios_ = true;
+        }
+
         ASSERT(bios_.size() == 16_kb);
         update_waitstate_table();
+
+        if(hle_bios_) {
+            skip_bios();
+        }
     }
 
     void skip_bios() noexcept;
@@ -124,8 +136,7 @@ private:
     [[nodiscard]] FORCEINLINE u8& stall_cycles(const mem_access access, const memory_page page) noexcept
     {
         if(UNLIKELY(page > memory_page::pak_sram_2)) {
-            static u8 unused_area_cycles = 1_u8;
-            return unused_area_cycles;
+            return unused_area_cycles_;
         }
 
         ASSERT(access != mem_access::none);
@@ -114,6 +114,10 @@ public:
 private:
     static void latch(channel& channel, bool for_repeat, bool for_fifo) noexcept;
 
+    template<typename T>
+    [[nodiscard]] u32 transfer_block(channel& channel) noexcept;
+    [[nodiscard]] u32 transfer_fifo(channel& channel) noexcept;
+
     void on_channel_start(u32 /*late_cycles*/) noexcept;
     void schedule(channel& channel, channel::control::timing timing) noexcept;
 };
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#ifndef GAMEBOIADVANCE_PAGE_TABLE_H
+#define GAMEBOIADVANCE_PAGE_TABLE_H
+
+#include <algorithm>
+
+#include <gba/core/container.h>
+#include <gba/core/integer.h>
+#include <gba/helper/macros.h>
+
+namespace gba::cpu {
+
+/*
+ * Host pointers for the parts of the address space which are plain memory,
+ * split into 16K pages. Memory smaller than a page (palette, oam) is mirrored
+ * inside the page through the page mask. Unmapped pages (bios, io, sram,
+ * eeprom, gpio, out of range rom) take the slow path through the bus.
+ */
+class page_table {
+public:
+    static constexpr u32 page_shift = 14_u32;
+    static constexpr u32 page_size = 1_u32 << page_shift;
+    static constexpr usize page_count = 0x1000'0000_usize >> page_shift.get();
+
+private:
+    struct page {
+        u8* data = nullptr;
+        u32 mask;
+    };
+
+    vector<page> read_pages_{page_count};
+    vector<page> write_pages_{page_count};
+
+public:
+    [[nodiscard]] FORCEINLINE const u8* read_ptr(const u32 addr) const noexcept { return lookup(read_pages_, addr); }
+    [[nodiscard]] FORCEINLINE u8* write_ptr(const u32 addr) const noexcept { return lookup(write_pages_, addr); }
+
+    // maps [addr, addr + size) to memory, repeating it every memory_size bytes
+    void map(const u32 addr, const u32 size, u8* memory, const u32 memory_size, const bool writable) noexcept
+    {
+        ASSERT((addr & (page_size - 1_u32)) == 0_u32 && (size & (page_size - 1_u32)) == 0_u32);
+        const u32 mask = std::min(memory_size, page_size) - 1_u32;
+        for(u32 offset = 0_u32; offset < size; offset += page_size) {
+            const page p{memory + (memory_size > page_size ? offset % memory_size : 0_u32).get(), mask};
+            read_pages_[index_of(addr + offset)] = p;
+            write_pages_[index_of(addr + offset)] = writable ? p : page{};
+        }
+    }
+
+    // read-only memory (rom images) is never handed out through write_ptr
+    void map(const u32 addr, const u32 size, const u8* memory, const u32 memory_size) noexcept
+    {
+        map(addr, size, const_cast<u8*>(memory), memory_size, false); // NOLINT
+    }
+
+    void unmap(const u32 addr, const u32 size) noexcept
+    {
+        for(u32 offset = 0_u32; offset < size; offset += page_size) {
+            read_pages_[index_of(addr + offset)] = page{};
+            write_pages_[index_of(addr + offset)] = page{};
+        }
+    }
+
+private:
+    [[nodiscard]] static FORCEINLINE usize index_of(const u32 addr) noexcept { return usize{addr >> page_shift}; }
+
+    [[nodiscard]] static FORCEINLINE u8* lookup(const vector<page>& pages, const u32 addr) noexcept
+    {
+        const usize index = index_of(addr);
+        if(UNLIKELY(index >= page_count)) {
+            return nullptr;
+        }
+
+        const page& p = pages[index];
+        return p.data ? p.data + (addr & p.mask).get() : nullptr;
+    }
+};
+
+} // namespace gba::cpu
+
+#endif //GAMEBOIADVANCE_PAGE_TABLE_H
@@ -57,6 +57,8 @@ public:
     [[nodiscard]] u8 read(register_type reg) const noexcept;
     void write(register_type reg, u8 data) noexcept;
 
+    [[nodiscard]] u16 read_counter() const noexcept;
+
     [[nodiscard]] FORCEINLINE u32 id() const noexcept { return id_; }
 
     void serialize(archive& archive) const noexcept;
@@ -23,8 +23,13 @@ void write_file(const path& path, const vector<u8>& data);
 void write_file(const path& path, view<u8> data);
 
 class mmap {
+public:
+    enum class access { read_write, read_only };
+
+private:
     fs::path path_;
     usize mapped_size_;
+    access access_ = access::read_write;
 
     struct impl;
     std::unique_ptr<impl> impl_;
@@ -44,6 +49,8 @@ public:
     mmap() noexcept;
     mmap(fs::path path, std::error_code& err) noexcept;
     mmap(fs::path path, usize map_size, std::error_code& err) noexcept;
+    // writing through a read_only mapping faults
+    mmap(fs::path path, access mode, std::error_code& err) noexcept;
 
     ~mmap() noexcept;
 
@@ -75,6 +82,7 @@ public:
     void unmap(std::error_code& err) noexcept;
     void flush(std::error_code& err) const noexcept;
     [[nodiscard]] bool is_mapped() const noexcept;
+    [[nodiscard]] bool is_read_only() const noexcept { return access_ == access::read_only; }
 
     [[nodiscard]] iterator begin() noexcept { return data(); }
     [[nodiscard]] iterator end() noexcept { return ptr(mapped_size_); }
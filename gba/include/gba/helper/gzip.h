@@ -8,15 +8,24 @@
 #ifndef GAMEBOIADVANCE_GZIP_H
 #define GAMEBOIADVANCE_GZIP_H
 
+#include <functional>
 #include <optional>
 
 #include <gba/core/container.h>
+#include <gba/helper/filesystem.h>
 
 namespace gba::gzip {
 
+// receives inflated data as soon as it is produced, the view is only valid during the call
+using chunk_callback = std::function<void(view<u8>)>;
+
 std::optional<vector<u8>> compress(const vector<u8>& decompressed) noexcept;
 std::optional<vector<u8>> decompress(const vector<u8>& compressed) noexcept;
 
+// inflates the file through a fixed size input buffer, fails if the output grows past max_size
+std::optional<vector<u8>> decompress_file(const fs::path& path, usize max_size,
+  const chunk_callback& on_chunk = chunk_callback{}) noexcept;
+
 } // namespace gba::gzip
 
 #endif  // GAMEBOIADVANCE_GZIP_H
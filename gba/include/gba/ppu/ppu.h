@@ -8,6 +8,8 @@
 #ifndef GAMEBOIADVANCE_PPU_H
 #define GAMEBOIADVANCE_PPU_H
 
+#include <memory>
+
 #include <gba/cpu/dma_controller.h>
 #include <gba/cpu/irq_controller_handle.h>
 #include <gba/cpu/mmio_addr.h>
@@ -25,12 +27,38 @@ constexpr u32::type tile_dot_count = 8_u32;
 
 using scanline_buffer = array<color, screen_width>;
 
+class scanline_worker;
+
+// everything besides video memory a scanline is rendered with
+struct line_registers {
+    ppu::dispcnt dispcnt;
+    u8 vcount;
+
+    bg_regular bg0{0_u32};
+    bg_regular bg1{1_u32};
+    bg_affine bg2{2_u32};
+    bg_affine bg3{3_u32};
+
+    window win0{0_u32};
+    window win1{1_u32};
+    ppu::win_in win_in;
+    ppu::win_out win_out;
+    array<bool, 2> win_can_draw_flags{false, false};
+
+    bool green_swap = false;
+    mosaic mosaic_bg;
+    mosaic mosaic_obj;
+    ppu::bldcnt bldcnt;
+    ppu::blend_settings blend_settings;
+};
+
 class engine {
     friend core;
+    friend scanline_worker;
 
     cpu::irq_controller_handle irq_;
     dma::controller_handle dma_;
-    scheduler* scheduler_;
+    scheduler* scheduler_ = nullptr;
 
     vector<u8> palette_ram_{1_kb};
     vector<u8> vram_{96_kb};
@@ -62,6 +90,18 @@ class engine {
     array<obj_buffer_entry, screen_width> obj_buffer_;
     array<win_enable_bits*, screen_width> win_buffer_;
 
+    // video memory written since the last line was handed to the worker, vram then palette then oam
+    static constexpr usize dirty_block_size = 1_kb;
+    static constexpr usize dirty_block_count = 98_usize;
+    array<bool, dirty_block_count.get()> dirty_blocks_{};
+
+    std::unique_ptr<scanline_worker> worker_;
+
+    // bumped on every write, decoded tiles are valid while the generations they were decoded at still match
+    static constexpr usize palette_bank_count = 32_usize;
+    array<u32, 96> vram_generations_{};                                 // per 1K block
+    array<u32, palette_bank_count.get() + 2_usize> palette_generations_{}; // per 16 color bank, then bg and obj 256 colors
+
 public:
     static constexpr u32 cycles_per_frame = 280'896_u32;
 
@@ -69,20 +109,105 @@ public:
     event<> event_on_vblank;
 
     explicit engine(scheduler* scheduler) noexcept;
+    ~engine();
+
+    engine(const engine&) = delete;
+    engine(engine&&) = delete;
+    engine& operator=(const engine&) = delete;
+    engine& operator=(engine&&) = delete;
 
     void set_irq_controller_handle(const cpu::irq_controller_handle irq) noexcept { irq_ = irq; }
     void set_dma_controller_handle(const dma::controller_handle dma) noexcept { dma_ = dma; }
 
     void check_vcounter_irq() noexcept;
 
+    // renders lines on a worker thread, finished lines are still reported on this thread right before vblank
+    void set_threaded_rendering(bool enabled);
+    [[nodiscard]] bool threaded_rendering() const noexcept { return worker_ != nullptr; }
+
+    FORCEINLINE void on_vram_write(const usize offset, const usize size) noexcept
+    {
+        const usize last_block = (offset + size - 1_usize) / dirty_block_size;
+        for(usize block = offset / dirty_block_size; block <= last_block; ++block) {
+            dirty_blocks_[block] = true;
+            ++vram_generations_[block];
+        }
+    }
+
+    FORCEINLINE void on_palette_write(const usize offset, const usize size) noexcept
+    {
+        dirty_blocks_[96_usize] = true;
+
+        const usize last_bank = (offset + size - 1_usize) / 32_usize;
+        for(usize bank = offset / 32_usize; bank <= last_bank; ++bank) {
+            ++palette_generations_[bank];
+            ++palette_generations_[palette_bank_count + bank / 16_usize];
+        }
+    }
+
+    FORCEINLINE void on_oam_write(const usize offset, const usize size) noexcept
+    {
+        dirty_blocks_[97_usize] = true;
+
+        const usize last_obj = (offset + size - 1_usize) / 8_usize;
+        for(usize obj = offset / 8_usize; obj <= last_obj; ++obj) {
+            obj_lines_valid_[obj] = false;
+        }
+        all_obj_lines_valid_ = false;
+    }
+
     void serialize(archive& archive) const noexcept;
     void deserialize(const archive& archive) noexcept;
 
 private:
     enum class palette_8bpp_target { bg = 0_u32, obj = 16_u32 };
 
+    // render only copy for the worker thread, never scheduled
+    engine() noexcept = default;
+
+    [[nodiscard]] u8* dirty_block_data(usize block) noexcept;
+    void on_block_write(usize block) noexcept;
+    void invalidate_video_memory() noexcept;
+
+    [[nodiscard]] line_registers save_line_registers() const noexcept;
+    void load_line_registers(const line_registers& registers) noexcept;
+    void flush_rendered_lines() noexcept;
+
     using tile_line = array<color, tile_dot_count>;
 
+    struct decoded_tile_line {
+        static constexpr u32 invalid_generation = 0xFFFF'FFFF_u32;
+
+        tile_line dots;
+        u32 vram_generation = invalid_generation;
+        u32 palette_generation;
+        u8 palette_idx;
+    };
+
+    // bg tile rows resolved to colors, indexed by row address
+    vector<decoded_tile_line> decoded_lines_4bpp_{96_kb / 4_usize};
+    vector<decoded_tile_line> decoded_lines_8bpp_{96_kb / 8_usize};
+
+    static constexpr usize obj_count = 128_usize;
+
+    struct obj_lines {
+        dimension<u8> dimensions;
+        dimension<u8> half_dimensions;
+        i32 x; // center
+        i32 y;
+        bool is_affine = false;
+
+        // visible lines [first_line, end_line) the obj covers
+        u8 first_line;
+        u8 end_line;
+    };
+
+    // objs covering every line as bits in oam order, objs written to are redone before the next line is rendered
+    array<obj_lines, obj_count.get()> obj_lines_;
+    array<array<u64, 2>, screen_height> line_objs_{};
+    array<bool, obj_count.get()> obj_lines_valid_{};
+    bool all_obj_lines_valid_ = false;
+
     void on_hblank(u32 late_cycles) noexcept;
     void on_hdraw(u32 late_cycles) noexcept;
 
@@ -97,6 +222,7 @@ private:
     template<typename F>
     void render_affine_loop(const bg_affine& bg, i32 w, i32 h, F&& render_func) noexcept;
 
+    void update_obj_lines() noexcept;
     void render_obj() noexcept;
 
     template<typename... BG>
@@ -108,6 +234,9 @@ private:
     void generate_window_buffer() noexcept;
     void generate_window_buffer(window& win, win_enable_bits* enable_bits) noexcept;
     void compose_impl(static_vector<bg_priority_pair, 4> ids) noexcept;
+    // ids in least importance order, both write the same final_buffer_
+    void compose_simd(const static_vector<bg_priority_pair, 4>& ids) noexcept;
+    void compose_scalar(const static_vector<bg_priority_pair, 4>& ids) noexcept;
     [[nodiscard]] color blend(color first, color second, bldcnt::effect type) const noexcept;
 
     template<typename BG>
@@ -131,8 +260,8 @@ private:
         return color{memcpy<u16>(palette_ram_, (palette_idx * 16_u32 + color_idx) * 2_u16) & 0x7FFF_u16};
     }
 
-    void tile_line_8bpp(tile_line& out_line, u32 y, usize base_addr, bg_map_entry entry) const noexcept;
-    void tile_line_4bpp(tile_line& out_line, u32 y, usize base_addr, bg_map_entry entry) const noexcept;
+    void tile_line_8bpp(tile_line& out_line, u32 y, usize base_addr, bg_map_entry entry) noexcept;
+    void tile_line_4bpp(tile_line& out_line, u32 y, usize base_addr, bg_map_entry entry) noexcept;
 
     [[nodiscard]] color tile_dot_8bpp(u32 x, u32 y, usize tile_addr, palette_8bpp_target target) const noexcept;
     [[nodiscard]] color tile_dot_4bpp(u32 x, u32 y, usize tile_addr, u8 palette_idx) const noexcept;
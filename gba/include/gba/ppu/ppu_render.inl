@@ -9,7 +9,6 @@
 #define GAMEBOIADVANCE_PPU_RENDER_INL
 
 #include <algorithm>
-#include <map>
 
 #include <gba/helper/range.h>
 
@@ -133,7 +132,6 @@ void engine::render_bg_regular_impl(const BG& bg) noexcept
     const u16 map_y = (vcount_ + bg.voffset - mosaic_v_offset) & map_mask.v;
     const u8 tile_y = narrow<u8>(map_y / tile_dot_count);
 
-    std::map<bg_map_entry, tile_line> tile_line_cache;
     tile_line current_tile_line;
 
     for(u16 screen_x = 0_u16; screen_x < screen_width;) {
@@ -142,21 +140,15 @@ void engine::render_bg_regular_impl(const BG& bg) noexcept
         const u32 block_index = map_entry_index(tile_x, tile_y, bg);
 
         const bg_map_entry entry{memcpy<u16>(vram_, map_entry_base + block_index * 2_u32)};
-        if(const auto it = tile_line_cache.find(entry); it != tile_line_cache.end()) {
-            current_tile_line = it->second;
+        const u16 dot_y = (map_y & 7_u16) ^ (7_u16 * bit::from_bool<u16>(entry.vflipped()));
+        if(bg.cnt.color_depth_8bit) {
+            tile_line_8bpp(current_tile_line, dot_y, tile_base, entry);
         } else {
-            const u16 dot_y = (map_y & 7_u16) ^ (7_u16 * bit::from_bool<u16>(entry.vflipped()));
-            if(bg.cnt.color_depth_8bit) {
-                tile_line_8bpp(current_tile_line, dot_y, tile_base, entry);
-            } else {
-                tile_line_4bpp(current_tile_line, dot_y, tile_base, entry);
-            }
-
-            if(entry.hflipped()) {
-                std::reverse(current_tile_line.begin(), current_tile_line.end());
-            }
+            tile_line_4bpp(current_tile_line, dot_y, tile_base, entry);
+        }
 
-            tile_line_cache.emplace(entry, current_tile_line);
+        if(entry.hflipped()) {
+            std::reverse(current_tile_line.begin(), current_tile_line.end());
         }
 
         const u32 start_x = screen_x == 0_u32
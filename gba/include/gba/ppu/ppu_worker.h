@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#ifndef GAMEBOIADVANCE_PPU_WORKER_H
+#define GAMEBOIADVANCE_PPU_WORKER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <gba/ppu/ppu.h>
+
+namespace gba::ppu {
+
+/*
+ * Renders scanlines on a thread of its own. At hblank the engine hands over the registers
+ * of the line and the video memory blocks written to since the previous one. The worker applies
+ * them to a private copy of the engine in the same order, so mid-frame raster effects come out
+ * exactly as if the line was rendered on the spot. At most a frame worth of lines is in flight.
+ */
+class scanline_worker {
+    struct job {
+        line_registers registers;
+        vector<u8> block_ids;
+        vector<u8> block_data;
+    };
+
+    std::unique_ptr<engine> renderer_;
+    array<scanline_buffer, screen_height> frame_;
+    array<bool, screen_height> rendered_lines_;
+
+    vector<job> jobs_{usize{screen_height}};
+    usize first_job_;
+    usize job_count_;
+
+    std::mutex mutex_;
+    std::condition_variable job_available_;
+    std::condition_variable job_done_;
+    bool stopping_ = false;
+
+    std::thread thread_;
+
+public:
+    scanline_worker();
+    ~scanline_worker();
+
+    scanline_worker(const scanline_worker&) = delete;
+    scanline_worker(scanline_worker&&) = delete;
+    scanline_worker& operator=(const scanline_worker&) = delete;
+    scanline_worker& operator=(scanline_worker&&) = delete;
+
+    // snapshots the line vcount of source and clears its dirty blocks
+    void submit(engine& source);
+
+    // blocks until every submitted line is rendered
+    void wait_idle();
+
+    // calls f with every line rendered since the last call in order, must follow wait_idle
+    template<typename F>
+    void take_rendered_lines(F&& f)
+    {
+        for(u32 line = 0_u32; line < screen_height; ++line) {
+            if(rendered_lines_[line]) {
+                rendered_lines_[line] = false;
+                f(narrow<u8>(line), frame_[line]);
+            }
+        }
+    }
+
+private:
+    void worker_loop();
+    void render(job& j);
+};
+
+} // namespace gba::ppu
+
+#endif //GAMEBOIADVANCE_PPU_WORKER_H
@@ -25,23 +25,23 @@ constexpr array<i16, 2> dma_volume_tab{2_i16, 4_i16};
 
 engine::engine(timer::timer* timer1, timer::timer* timer2, scheduler* scheduler) noexcept
   : scheduler_{scheduler},
-    channel_1_{scheduler},
-    channel_2_{scheduler},
+    channel_1_{scheduler, scheduler::event_source::apu_pulse1},
+    channel_2_{scheduler, scheduler::event_source::apu_pulse2},
     channel_3_{scheduler},
     channel_4_{scheduler},
     fifo_a_{&control_.fifo_a, dma::occasion::fifo_a},
     fifo_b_{&control_.fifo_b, dma::occasion::fifo_b},
     resampler_{buffer_}
 {
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT(apu::engine::tick_sequencer), "apu::sequencer");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT(apu::engine::tick_mixer), "apu::mixer");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(apu::pulse_channel::generate_output_sample, &channel_1_), "apu::pulse1::output");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(apu::pulse_channel::generate_output_sample, &channel_2_), "apu::pulse2::output");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(apu::wave_channel::generate_output_sample, &channel_3_), "apu::wave::output");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(apu::noise_channel::generate_output_sample, &channel_4_), "apu::noise::output");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT(apu::engine::tick_sequencer), "apu::sequencer");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT(apu::engine::tick_mixer), "apu::mixer");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT_V(apu::pulse_channel::generate_output_sample, &channel_1_), "apu::pulse1::output");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT_V(apu::pulse_channel::generate_output_sample, &channel_2_), "apu::pulse2::output");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT_V(apu::wave_channel::generate_output_sample, &channel_3_), "apu::wave::output");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT_V(apu::noise_channel::generate_output_sample, &channel_4_), "apu::noise::output");
 
-    scheduler_->add_hw_event(frame_sequencer_cycles, MAKE_HW_EVENT(apu::engine::tick_sequencer));
-    scheduler_->add_hw_event(soundbias_.sample_interval(), MAKE_HW_EVENT(apu::engine::tick_mixer));
+    scheduler_->add_hw_event(scheduler::event_source::apu_sequencer, frame_sequencer_cycles, MAKE_HW_EVENT(apu::engine::tick_sequencer));
+    scheduler_->add_hw_event(scheduler::event_source::apu_mixer, soundbias_.sample_interval(), MAKE_HW_EVENT(apu::engine::tick_mixer));
 
     timer1->on_overflow.add_delegate({connect_arg<&engine::on_timer_overflow>, this});
     timer2->on_overflow.add_delegate({connect_arg<&engine::on_timer_overflow>, this});
@@ -51,7 +51,7 @@ engine::engine(timer::timer* timer1, timer::timer* timer2, scheduler* scheduler)
 
 void engine::tick_sequencer(const u32 late_cycles) noexcept
 {
-    scheduler_->add_hw_event(frame_sequencer_cycles - late_cycles, MAKE_HW_EVENT(apu::engine::tick_sequencer));
+    scheduler_->add_hw_event(scheduler::event_source::apu_sequencer, frame_sequencer_cycles - late_cycles, MAKE_HW_EVENT(apu::engine::tick_sequencer));
 
     switch(frame_sequencer_.get()) {
         case 0:
@@ -88,7 +88,7 @@ void engine::tick_mixer(const u32 late_cycles) noexcept
       static_cast<float>(generate_sample(terminal::right).get()) / static_cast<float>(0x200)
     });
 
-    scheduler_->add_hw_event(soundbias_.sample_interval() - late_cycles, MAKE_HW_EVENT(apu::engine::tick_mixer));
+    scheduler_->add_hw_event(scheduler::event_source::apu_mixer, soundbias_.sample_interval() - late_cycles, MAKE_HW_EVENT(apu::engine::tick_mixer));
 }
 
 i16 engine::generate_sample(const u32 terminal) noexcept
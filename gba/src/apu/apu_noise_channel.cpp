@@ -14,12 +14,12 @@ namespace gba::apu {
 noise_channel::noise_channel(scheduler* scheduler) noexcept
   : scheduler_{scheduler}
 {
-    timer_event_id = scheduler_->add_hw_event(calculate_sample_rate(), MAKE_HW_EVENT(noise_channel::generate_output_sample));
+    timer_event_id = scheduler_->add_hw_event(scheduler::event_source::apu_noise, calculate_sample_rate(), MAKE_HW_EVENT(noise_channel::generate_output_sample));
 }
 
 void noise_channel::generate_output_sample(const u32 late_cycles) noexcept
 {
-    timer_event_id = scheduler_->add_hw_event(calculate_sample_rate() - late_cycles, MAKE_HW_EVENT(noise_channel::generate_output_sample));
+    timer_event_id = scheduler_->add_hw_event(scheduler::event_source::apu_noise, calculate_sample_rate() - late_cycles, MAKE_HW_EVENT(noise_channel::generate_output_sample));
 
     const u16 first_bit_reverse = bit::extract(~lfsr, 0_u8);
     const u16 result = bit::extract(lfsr, 0_u8) ^ bit::extract(lfsr, 1_u8);
@@ -76,7 +76,7 @@ void noise_channel::envelope_click() noexcept
 void noise_channel::restart() noexcept
 {
     scheduler_->remove_event(timer_event_id);
-    timer_event_id = scheduler_->add_hw_event(calculate_sample_rate(), MAKE_HW_EVENT(noise_channel::generate_output_sample));
+    timer_event_id = scheduler_->add_hw_event(scheduler::event_source::apu_noise, calculate_sample_rate(), MAKE_HW_EVENT(noise_channel::generate_output_sample));
 
     enabled = true;
     length_counter = sound_length;
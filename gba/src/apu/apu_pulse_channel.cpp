@@ -22,10 +22,11 @@ constexpr array<i32, 32> wave_duty{
 
 } // namespace
 
-pulse_channel::pulse_channel(scheduler* scheduler) noexcept
-  : scheduler_{scheduler}
+pulse_channel::pulse_channel(scheduler* scheduler, const scheduler::event_source event_source) noexcept
+  : scheduler_{scheduler},
+    event_source_{event_source}
 {
-    timer_event_id = scheduler_->add_hw_event(calculate_sample_rate(), MAKE_HW_EVENT(pulse_channel::generate_output_sample));
+    timer_event_id = scheduler_->add_hw_event(event_source_, calculate_sample_rate(), MAKE_HW_EVENT(pulse_channel::generate_output_sample));
 }
 
 void pulse_channel::generate_output_sample(const u32 late_cycles) noexcept
@@ -34,7 +35,7 @@ void pulse_channel::generate_output_sample(const u32 late_cycles) noexcept
     adjust_waveform_duty_index();
     adjust_output_volume();
 
-    timer_event_id = scheduler_->add_hw_event(calculate_sample_rate() - late_cycles, MAKE_HW_EVENT(pulse_channel::generate_output_sample));
+    timer_event_id = scheduler_->add_hw_event(event_source_, calculate_sample_rate() - late_cycles, MAKE_HW_EVENT(pulse_channel::generate_output_sample));
 }
 
 i8 pulse_channel::get_output() const noexcept
@@ -104,7 +105,7 @@ void pulse_channel::envelope_click() noexcept
 void pulse_channel::restart() noexcept
 {
     scheduler_->remove_event(timer_event_id);
-    timer_event_id = scheduler_->add_hw_event(calculate_sample_rate(), MAKE_HW_EVENT(pulse_channel::generate_output_sample));
+    timer_event_id = scheduler_->add_hw_event(event_source_, calculate_sample_rate(), MAKE_HW_EVENT(pulse_channel::generate_output_sample));
 
     enabled = true;
     length_counter = 64_u32 - wav_data.sound_length;
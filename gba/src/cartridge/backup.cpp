@@ -126,7 +126,7 @@ void backup_eeprom::write(const u32 /*address*/, u8 value) noexcept
                 LOG_TRACE(eeprom, "new state: waiting_finish_bit after transmitting");
 
                 settled_response_ = 0_u8;
-                scheduler_->add_hw_event(eeprom_settle_cycles, MAKE_HW_EVENT(backup_eeprom::on_settle));
+                scheduler_->add_hw_event(scheduler::event_source::eeprom, eeprom_settle_cycles, MAKE_HW_EVENT(backup_eeprom::on_settle));
             }
             break;
         }
@@ -211,9 +211,10 @@ void backup_eeprom::deserialize(const archive& archive) noexcept
     archive.deserialize(cmd_);
 }
 
-void backup_eeprom::register_settle_event() noexcept
+void backup_eeprom::set_scheduler(scheduler* s) noexcept
 {
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT(backup_eeprom::on_settle),"eeprom::settle");
+    backup::set_scheduler(s);
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT(backup_eeprom::on_settle), "eeprom::settle");
 }
 
 void backup_sram::write(const u32 address, const u8 value) noexcept
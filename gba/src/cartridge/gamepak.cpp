@@ -7,20 +7,31 @@
 
 #include <gba/cartridge/gamepak.h>
 
+#include <fstream>
+
+#define ZLIB_CONST
+#include <zlib.h>
+
 #include <gba/archive.h>
 #include <gba/cartridge/gamepak_db.h>
-#include <gba/helper/gzip.h>
 
 namespace gba::cartridge {
 
 namespace {
 
-std::string_view make_pak_str(const vector<u8>& data, const usize start, const usize len) noexcept
+using load_clock = std::chrono::steady_clock;
+
+std::chrono::microseconds elapsed_since(const load_clock::time_point start) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(load_clock::now() - start);
+}
+
+std::string_view make_pak_str(const rom_image& data, const usize start, const usize len) noexcept
 {
     return std::string_view{reinterpret_cast<const char*>(data.data() + start.get()), len.get()};  //NOLINT
 }
 
-std::string_view make_pak_str_zero_padded(const vector<u8>& data, const usize start, const usize max_len) noexcept
+std::string_view make_pak_str_zero_padded(const rom_image& data, const usize start, const usize max_len) noexcept
 {
     usize len;
     for(; len < max_len; ++len) {
@@ -30,6 +41,63 @@ std::string_view make_pak_str_zero_padded(const vector<u8>& data, const usize st
     return make_pak_str(data, start, len);
 }
 
+/*
+ * Signature scan results are cached next to the backups and states, keyed by the rom size
+ * and two checksums of the whole image. The cache stores where the signature was found and
+ * a hit is only taken if the rom still has it there. Roms without a signature are not cached,
+ * there would be nothing to verify a hit against.
+ */
+fs::path backup_scan_cache_path(const fs::path& pak_path, const rom_image& rom) noexcept
+{
+    const auto* data = reinterpret_cast<const Bytef*>(rom.data()); // NOLINT
+    const auto size = static_cast<uInt>(rom.size().get());
+    const uLong crc = crc32(crc32(0uL, Z_NULL, 0u), data, size);
+    const uLong adler = adler32(adler32(0uL, Z_NULL, 0u), data, size);
+
+    return pak_path.parent_path() / "cache" / fmt::format("{:08X}{:08X}{:08X}.backup", rom.size(), crc, adler);
+}
+
+std::optional<backup::type> read_backup_scan_cache(const fs::path& cache_path, const rom_image& rom) noexcept
+{
+    std::ifstream stream{cache_path};
+    std::string name;
+    if(!stream.is_open() || !(stream >> name)) {
+        return std::nullopt;
+    }
+
+    usize::type offset = 0u;
+    if(!(stream >> std::hex >> offset)) {
+        LOG_WARN(gamepak, "ignoring invalid backup scan cache {}", cache_path.string());
+        return std::nullopt;
+    }
+
+    const std::optional<backup_signature> signature = rom.backup_signature_at(name, usize{offset});
+    if(!signature.has_value()) {
+        LOG_WARN(gamepak, "backup scan cache {} belongs to another rom, rescanning", cache_path.string());
+        return std::nullopt;
+    }
+    return signature->type;
+}
+
+void write_backup_scan_cache(const fs::path& cache_path, const backup_signature& signature) noexcept
+{
+    if(signature.type == backup::type::detect) {
+        return;
+    }
+
+    // the cache is optional, roms can live in read-only directories
+    std::error_code err;
+    fs::create_directories(cache_path.parent_path(), err);
+
+    std::ofstream stream{cache_path};
+    if(err || !stream.is_open()) {
+        LOG_WARN(gamepak, "could not write backup scan cache {}", cache_path.string());
+        return;
+    }
+
+    stream << fmt::format("{} {:08X}\n", signature.name, signature.offset);
+}
+
 std::unique_ptr<backup> make_backup_from_type(const backup::type type, const fs::path& pak_path)
 {
     switch(type) {
@@ -56,42 +124,41 @@ std::unique_ptr<backup> make_backup_from_type(const backup::type type, const fs:
 
 void gamepak::load(const fs::path& path)
 {
+    const load_clock::time_point load_start = load_clock::now();
+
     path_ = path;
+    load_stats_ = pak_load_stats{};
 
     if(!fs::exists(path) || !fs::is_regular_file(path)) {
         loaded_ = false;
-        pak_data_.clear();
+        pak_data_ = std::make_shared<const rom_image>();
         backup_type_ = backup::type::none;
         backup_ = nullptr;
         return;
     }
 
-    pak_data_ = fs::read_file(path);
-    if(path.extension() == ".gz") {
-        std::optional<vector<u8>> decompressed = gzip::decompress(pak_data_);
-        if(decompressed.has_value()) {
-            pak_data_ = std::move(decompressed.value());
-        } else {
-            LOG_CRITICAL(gamepak, "could not decompress rom file");
-            PANIC();
-        }
-    }
-
+    pak_data_ = rom_image::open(path);
     loaded_ = true;
+    load_stats_.image_time = elapsed_since(load_start);
+    load_stats_.rom_size = pak_data_->size();
+    load_stats_.mapped = pak_data_->is_mapped();
 
-    game_title_ = make_pak_str_zero_padded(pak_data_, 0xA0_usize, 12_usize);
-    game_code_ = make_pak_str_zero_padded(pak_data_, 0xAC_usize, 4_usize);
-    maker_code_ = make_pak_str_zero_padded(pak_data_, 0xB0_usize, 2_usize);
+    const load_clock::time_point header_start = load_clock::now();
+    const rom_image& rom = *pak_data_;
+    game_title_ = make_pak_str_zero_padded(rom, 0xA0_usize, 12_usize);
+    game_code_ = make_pak_str_zero_padded(rom, 0xAC_usize, 4_usize);
+    maker_code_ = make_pak_str_zero_padded(rom, 0xB0_usize, 2_usize);
 
-    main_unit_code_ = pak_data_[0xB3_u32];
-    software_version_ = pak_data_[0xBC_u32];
-    checksum_ = pak_data_[0xBD_u32];
+    main_unit_code_ = rom[0xB3_u32];
+    software_version_ = rom[0xBC_u32];
+    checksum_ = rom[0xBD_u32];
 
     u8 calculated_checksum;
     for(u32 addr = 0xA0_u32; addr < 0xBD_u32; ++addr) {
-        calculated_checksum -= pak_data_[addr];
+        calculated_checksum -= rom[addr];
     }
     calculated_checksum -= 0x19_u8;
+    load_stats_.header_time = elapsed_since(header_start);
 
     LOG_INFO(gamepak, "------ gamepak ------");
     LOG_INFO(gamepak, "path: {}", path_.string());
@@ -107,10 +174,13 @@ void gamepak::load(const fs::path& path)
         LOG_INFO(gamepak, "checksum: {:02X}", calculated_checksum);
     }
 
+    const load_clock::time_point backup_detection_start = load_clock::now();
     detect_backup_type();
+    load_stats_.backup_detection_time = elapsed_since(backup_detection_start);
+
     if(has_mirroring_) {
         mirror_mask_ = 1_u32;
-        while(mirror_mask_ < pak_data_.size()) {
+        while(mirror_mask_ < pak_data_->size()) {
             mirror_mask_ <<= 1_u32;
         }
         mirror_mask_ -= 1_u32;
@@ -121,9 +191,27 @@ void gamepak::load(const fs::path& path)
     LOG_INFO(gamepak, "rtc: {}", has_rtc_);
     LOG_INFO(gamepak, "address mirroring: {}, mask: {:08X}", has_mirroring_, mirror_mask_);
 
+    load_stats_.total_time = elapsed_since(load_start);
+    LOG_INFO(gamepak, "loaded {} bytes ({}) in {} us: image {} us, header {} us, backup detection {} us",
+      load_stats_.rom_size, load_stats_.mapped ? "mapped" : "in memory", load_stats_.total_time.count(),
+      load_stats_.image_time.count(), load_stats_.header_time.count(), load_stats_.backup_detection_time.count());
+
     LOG_INFO(gamepak, "---------------------");
 }
 
+fs::path gamepak::save_base_path() const
+{
+    if(save_suffix_.empty()) {
+        return path_;
+    }
+
+    // the suffix goes before the extension, which backups and states replace
+    fs::path path = path_;
+    path.replace_filename(fmt::format("{}.{}{}", path_.stem().string(), save_suffix_,
+      path_.has_extension() ? path_.extension().string() : std::string{".gba"}));
+    return path;
+}
+
 void gamepak::detect_backup_type() noexcept
 {
     const std::optional<pak_db_entry> entry = query_pak_db(game_code_);
@@ -133,36 +221,29 @@ void gamepak::detect_backup_type() noexcept
         has_mirroring_ = entry->has_mirroring;
         has_rtc_ = entry->has_rtc;
 
-        backup_ = make_backup_from_type(backup_type_, path_);
+        backup_ = make_backup_from_type(backup_type_, save_base_path());
         LOG_INFO(gamepak, "backup: {} (database entry)", to_string_view(backup_type_));
         return;
     }
 
-    using namespace std::string_view_literals;
-    static constexpr array backup_type_strings{
-      std::make_pair("EEPROM_V"sv, backup::type::eeprom_undetected),
-      std::make_pair("SRAM_V"sv, backup::type::sram),
-      std::make_pair("SRAM_F_V"sv, backup::type::sram),
-      std::make_pair("FLASH_V"sv, backup::type::flash_64),
-      std::make_pair("FLASH512_V"sv, backup::type::flash_64),
-      std::make_pair("FLASH1M_V"sv, backup::type::flash_128),
-    };
-
-    std::string_view pak_str = make_pak_str(pak_data_, 0_usize, pak_data_.size());
-    for(const auto& [name, type] : backup_type_strings) {
-        if(pak_str.find(name) != std::string_view::npos) {
-            backup_type_ = type;
-            backup_ = make_backup_from_type(backup_type_, path_);
-            break;
-        }
+    const fs::path cache_path = backup_scan_cache_path(path_, *pak_data_);
+    const std::optional<backup::type> cached_type = read_backup_scan_cache(cache_path, *pak_data_);
+    load_stats_.backup_scan_cached = cached_type.has_value();
+    if(cached_type.has_value()) {
+        backup_type_ = cached_type.value();
+    } else {
+        const backup_signature signature = pak_data_->scan_backup_signature();
+        backup_type_ = signature.type;
+        write_backup_scan_cache(cache_path, signature);
     }
 
     if(backup_type_ == backup::type::detect) {
         backup_type_ = backup::type::sram;
-        backup_ = std::make_unique<backup_sram>(path_);
+        backup_ = std::make_unique<backup_sram>(save_base_path());
         LOG_WARN(gamepak, "backup: {} (fallback)", to_string_view(backup_type_));
     } else {
-        LOG_INFO(gamepak, "backup: {}", to_string_view(backup_type_));
+        backup_ = make_backup_from_type(backup_type_, save_base_path());
+        LOG_INFO(gamepak, "backup: {}{}", to_string_view(backup_type_), cached_type.has_value() ? " (cached)" : "");
     }
 }
 
@@ -7,8 +7,17 @@
 
 #include <gba/cartridge/gamepak_db.h>
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include <gba/core/math.h>
+
 namespace gba::cartridge {
 
+namespace {
+
 // taken from https://github.com/fleroviux/NanoboyAdvance/blob/master/source/emulator/cartridge/game_db.cpp
 constexpr array pak_db {
   pak_db_entry{"ALFP", backup::type::eeprom_64, false, false}, /* Dragon Ball Z - The Legacy of Goku II (Europe)(En,Fr,De,Es,It) */
@@ -124,15 +133,191 @@ constexpr array pak_db {
   pak_db_entry{"ALUE", backup::type::eeprom_4, false, false}   /* 0763 - Super Monkey Ball Jr. (USA) */
 };
 
+template<usize::type N>
+constexpr array<pak_db_entry, N> sort_by_game_code(array<pak_db_entry, N> entries) noexcept
+{
+    // insertion sort, std::sort is not constexpr yet
+    for(usize i = 1_usize; i < entries.size(); ++i) {
+        for(usize j = i; j > 0_usize && entries[j].game_code < entries[j - 1_usize].game_code; --j) {
+            const pak_db_entry tmp = entries[j];
+            entries[j] = entries[j - 1_usize];
+            entries[j - 1_usize] = tmp;
+        }
+    }
+    return entries;
+}
+
+template<usize::type N>
+constexpr bool has_unique_game_codes(const array<pak_db_entry, N>& sorted_entries) noexcept
+{
+    for(usize i = 1_usize; i < sorted_entries.size(); ++i) {
+        if(sorted_entries[i].game_code == sorted_entries[i - 1_usize].game_code) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr auto sorted_pak_db = sort_by_game_code(pak_db);
+static_assert(has_unique_game_codes(sorted_pak_db), "duplicate game code in pak db");
+
+/*
+ * External database layout, all integers little endian:
+ *   header: "GBAPAKDB", u32 version, u32 entry count
+ *   entry:  char game_code[4], u8 backup type, u8 flags (bit 0 rtc, bit 1 mirroring), u16 reserved
+ * entries are sorted by game code so they can be binary searched in place.
+ */
+constexpr std::string_view overlay_magic = "GBAPAKDB";
+constexpr u32 overlay_version = 1_u32;
+constexpr usize overlay_header_size = 16_usize;
+constexpr usize overlay_entry_size = 8_usize;
+constexpr usize game_code_size = 4_usize;
+
+class pak_db_overlay {
+    fs::mmap mapping_;
+    usize entry_count_;
+
+public:
+    pak_db_overlay(fs::mmap mapping, const usize entry_count) noexcept
+      : mapping_{std::move(mapping)},
+        entry_count_{entry_count} {}
+
+    [[nodiscard]] usize size() const noexcept { return entry_count_; }
+
+    [[nodiscard]] std::string_view game_code(const usize idx) const noexcept
+    {
+        return std::string_view{reinterpret_cast<const char*>(entry_ptr(idx)), game_code_size.get()}; // NOLINT
+    }
+
+    [[nodiscard]] std::optional<pak_db_entry> find(const std::string_view code) const noexcept
+    {
+        usize first;
+        usize count = entry_count_;
+        while(count > 0_usize) {
+            const usize half = count / 2_usize;
+            if(game_code(first + half) < code) {
+                first += half + 1_usize;
+                count -= half + 1_usize;
+            } else {
+                count = half;
+            }
+        }
+
+        if(first == entry_count_ || game_code(first) != code) {
+            return std::nullopt;
+        }
+
+        const u8 flags = entry_ptr(first)[5];
+        return pak_db_entry{code, to_enum<backup::type>(backup_type_value(first)), bit::test(flags, 0_u8), bit::test(flags, 1_u8)};
+    }
+
+    [[nodiscard]] u8 backup_type_value(const usize idx) const noexcept { return entry_ptr(idx)[4]; }
+
+private:
+    [[nodiscard]] const u8* entry_ptr(const usize idx) const noexcept
+    {
+        return mapping_.ptr(overlay_header_size + idx * overlay_entry_size);
+    }
+};
+
+std::mutex overlay_mutex;
+std::shared_ptr<const pak_db_overlay> overlay;
+
+} // namespace
+
 std::optional<pak_db_entry> query_pak_db(const std::string_view game_code) noexcept
 {
-    const auto* it = std::find_if(pak_db.cbegin(), pak_db.cend(), [game_code](const pak_db_entry& entry) {
-        return entry.game_code == game_code;
-    });
+    std::shared_ptr<const pak_db_overlay> current_overlay;
+    {
+        std::lock_guard lock{overlay_mutex};
+        current_overlay = overlay;
+    }
+
+    if(current_overlay) {
+        if(const std::optional<pak_db_entry> entry = current_overlay->find(game_code); entry.has_value()) {
+            return entry;
+        }
+    }
 
-    return it == pak_db.cend()
+    const auto* it = std::lower_bound(sorted_pak_db.cbegin(), sorted_pak_db.cend(), game_code,
+      [](const pak_db_entry& entry, const std::string_view code) { return entry.game_code < code; });
+
+    return it == sorted_pak_db.cend() || it->game_code != game_code
       ? std::nullopt
-      : std::optional<pak_db_entry>{*it};
+      : std::optional<pak_db_entry>{pak_db_entry{game_code, it->backup_type, it->has_rtc, it->has_mirroring}};
+}
+
+bool load_pak_db_overlay(const fs::path& path) noexcept
+{
+    std::error_code err;
+    fs::mmap mapping{path, fs::mmap::access::read_only, err};
+    if(err) {
+        LOG_ERROR(gamepak, "could not map pak database {}: {}", path.string(), err.message());
+        return false;
+    }
+
+    if(mapping.size() < overlay_header_size
+      || std::string_view{reinterpret_cast<const char*>(mapping.data()), overlay_magic.size()} != overlay_magic) { // NOLINT
+        LOG_ERROR(gamepak, "{} is not a pak database", path.string());
+        return false;
+    }
+
+    if(const u32 version = memcpy<u32>(mapping, 8_usize); version != overlay_version) {
+        LOG_ERROR(gamepak, "unsupported pak database version {} in {}", version, path.string());
+        return false;
+    }
+
+    const usize entry_count{memcpy<u32>(mapping, 12_usize)};
+    if(mapping.size() != overlay_header_size + entry_count * overlay_entry_size) {
+        LOG_ERROR(gamepak, "pak database {} is truncated", path.string());
+        return false;
+    }
+
+    // validated once so lookups can trust the contents
+    auto db = std::make_shared<const pak_db_overlay>(std::move(mapping), entry_count);
+    for(usize i = 0_usize; i < entry_count; ++i) {
+        const bool sorted = i == 0_usize || db->game_code(i - 1_usize) < db->game_code(i);
+        if(!sorted || db->backup_type_value(i) > from_enum<u8>(backup::type::flash_128)) {
+            LOG_ERROR(gamepak, "pak database {} has an invalid entry at {}", path.string(), i);
+            return false;
+        }
+    }
+
+    LOG_INFO(gamepak, "loaded {} pak database entries from {}", entry_count, path.string());
+
+    std::lock_guard lock{overlay_mutex};
+    overlay = std::move(db);
+    return true;
+}
+
+void clear_pak_db_overlay() noexcept
+{
+    std::lock_guard lock{overlay_mutex};
+    overlay.reset();
+}
+
+void write_pak_db(const fs::path& path, vector<pak_db_entry> entries)
+{
+    std::sort(entries.begin(), entries.end(), [](const pak_db_entry& lhs, const pak_db_entry& rhs) {
+        return lhs.game_code < rhs.game_code;
+    });
+
+    vector<u8> bytes{overlay_header_size + entries.size() * overlay_entry_size};
+    std::memcpy(bytes.data(), overlay_magic.data(), overlay_magic.size());
+    memcpy(bytes, 8_usize, overlay_version);
+    memcpy(bytes, 12_usize, narrow<u32>(entries.size()));
+
+    for(usize i = 0_usize; i < entries.size(); ++i) {
+        const pak_db_entry& entry = entries[i];
+        ASSERT(entry.game_code.size() == game_code_size);
+
+        const usize offset = overlay_header_size + i * overlay_entry_size;
+        std::memcpy(bytes.ptr(offset), entry.game_code.data(), game_code_size.get());
+        bytes[offset + 4_usize] = from_enum<u8>(entry.backup_type);
+        bytes[offset + 5_usize] = bit::from_bool<u8>(entry.has_rtc) | bit::from_bool<u8>(entry.has_mirroring) << 1_u8;
+    }
+
+    fs::write_file(path, bytes);
 }
 
 } // namespace gba::cartridge
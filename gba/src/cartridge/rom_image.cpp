@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <gba/cartridge/rom_image.h>
+
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <gba/core/math.h>
+#include <gba/helper/gzip.h>
+
+namespace gba::cartridge {
+
+namespace {
+
+struct cache_entry {
+    std::weak_ptr<const rom_image> image;
+    usize file_size;
+    fs::file_time_type write_time;
+};
+
+constexpr array backup_signatures{
+  std::make_pair(std::string_view{"EEPROM_V"}, backup::type::eeprom_undetected),
+  std::make_pair(std::string_view{"SRAM_V"}, backup::type::sram),
+  std::make_pair(std::string_view{"SRAM_F_V"}, backup::type::sram),
+  std::make_pair(std::string_view{"FLASH_V"}, backup::type::flash_64),
+  std::make_pair(std::string_view{"FLASH512_V"}, backup::type::flash_64),
+  std::make_pair(std::string_view{"FLASH1M_V"}, backup::type::flash_128),
+};
+
+// finds backup library signatures in data fed piece by piece, a match may span two pieces
+class backup_signature_scanner {
+    static constexpr usize max_signature_length = 10_usize;
+
+    std::string tail_;
+    usize position_;
+    u32 found_signatures_;
+    array<usize, backup_signatures.size().get()> offsets_;
+
+public:
+    void feed(const view<u8> data) noexcept
+    {
+        const std::string_view piece{reinterpret_cast<const char*>(data.data()), data.size().get()}; // NOLINT
+        const usize::type overlap = max_signature_length.get() - 1u;
+
+        const usize tail_position = position_ - tail_.size();
+        tail_.append(piece.substr(0u, overlap));
+        search(tail_, tail_position);
+        search(piece, position_);
+        position_ += piece.size();
+
+        if(piece.size() >= overlap) {
+            tail_.assign(piece.substr(piece.size() - overlap));
+        } else if(tail_.size() > overlap) {
+            tail_.erase(0u, tail_.size() - overlap);
+        }
+    }
+
+    [[nodiscard]] backup_signature result() const noexcept
+    {
+        for(u32 i = 0_u32; i < backup_signatures.size(); ++i) {
+            if(bit::test(found_signatures_, narrow<u8>(i))) {
+                return backup_signature{backup_signatures[i].second, backup_signatures[i].first, offsets_[i]};
+            }
+        }
+        return backup_signature{};
+    }
+
+private:
+    // single pass: every signature ends in "_V", so only the underscores memchr finds are checked
+    void search(const std::string_view data, const usize data_position) noexcept
+    {
+        const char* begin = data.data();
+        const char* end = begin + data.size();
+        for(const char* underscore = begin;
+          (underscore = static_cast<const char*>(std::memchr(underscore, '_',
+            static_cast<usize::type>(end - underscore)))) != nullptr;
+          ++underscore) {
+            if(underscore + 1 == end || underscore[1] != 'V') {
+                continue;
+            }
+
+            const auto suffix_pos = static_cast<usize::type>(underscore - begin);
+            for(u32 i = 0_u32; i < backup_signatures.size(); ++i) {
+                const std::string_view signature = backup_signatures[i].first;
+                const usize::type name_size = signature.size() - 2u;
+                if(suffix_pos >= name_size && !bit::test(found_signatures_, narrow<u8>(i))
+                  && data.compare(suffix_pos - name_size, signature.size(), signature) == 0) {
+                    found_signatures_ = bit::set(found_signatures_, narrow<u8>(i));
+                    offsets_[i] = data_position + suffix_pos - name_size;
+                }
+            }
+        }
+    }
+};
+
+std::shared_ptr<const rom_image> load_image(const fs::path& path)
+{
+    if(path.extension() == ".gz") {
+        backup_signature_scanner scanner;
+        std::optional<vector<u8>> decompressed = gzip::decompress_file(path, rom_image::max_size,
+          [&](const view<u8> chunk) { scanner.feed(chunk); });
+        if(!decompressed.has_value()) {
+            LOG_CRITICAL(gamepak, "could not decompress rom file");
+            PANIC();
+        }
+        return std::make_shared<const rom_image>(std::move(decompressed.value()), scanner.result());
+    }
+
+    if(fs::file_size(path) != 0u) {
+        std::error_code err;
+        fs::mmap mapping{path, fs::mmap::access::read_only, err};
+        if(!err) {
+            return std::make_shared<const rom_image>(std::move(mapping));
+        }
+        LOG_WARN(gamepak, "could not map rom file, reading it instead: {}", err.message());
+    }
+
+    return std::make_shared<const rom_image>(fs::read_file(path));
+}
+
+} // namespace
+
+rom_image::rom_image(fs::mmap mapping) noexcept
+  : mapping_{std::move(mapping)},
+    data_{mapping_.data()},
+    size_{mapping_.size()} {}
+
+rom_image::rom_image(vector<u8> bytes) noexcept
+  : bytes_{std::move(bytes)},
+    data_{bytes_.data()},
+    size_{bytes_.size()} {}
+
+rom_image::rom_image(vector<u8> bytes, const backup_signature& scanned_signature) noexcept
+  : rom_image(std::move(bytes))
+{
+    std::call_once(backup_scan_flag_, [&]() { scanned_signature_ = scanned_signature; });
+}
+
+backup_signature rom_image::scan_backup_signature() const noexcept
+{
+    std::call_once(backup_scan_flag_, [&]() {
+        backup_signature_scanner scanner;
+        scanner.feed(view<u8>{data_, size_});
+        scanned_signature_ = scanner.result();
+    });
+    return scanned_signature_;
+}
+
+std::optional<backup_signature> rom_image::backup_signature_at(const std::string_view name, const usize offset) const noexcept
+{
+    for(const auto& [signature, type] : backup_signatures) {
+        if(signature == name && offset <= size_ && size_ - offset >= signature.size()
+          && std::memcmp(ptr(offset), signature.data(), signature.size()) == 0) {
+            return backup_signature{type, signature, offset};
+        }
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<const rom_image> rom_image::open(const fs::path& path)
+{
+    static std::mutex cache_mutex;
+    static std::unordered_map<std::string, cache_entry> cache;
+
+    std::error_code err;
+    fs::path key_path = fs::canonical(path, err);
+    if(err) {
+        key_path = path;
+    }
+
+    const usize file_size = fs::file_size(key_path);
+    const fs::file_time_type write_time = fs::last_write_time(key_path);
+
+    std::lock_guard lock{cache_mutex};
+
+    // the file changed on disk since it was cached, do not hand out stale contents
+    cache_entry& entry = cache[key_path.string()];
+    if(std::shared_ptr<const rom_image> image = entry.image.lock();
+      image && entry.file_size == file_size && entry.write_time == write_time) {
+        LOG_TRACE(gamepak, "sharing rom image of {}", key_path.string());
+        return image;
+    }
+
+    std::shared_ptr<const rom_image> image = load_image(key_path);
+    entry = cache_entry{image, file_size, write_time};
+    return image;
+}
+
+} // namespace gba::cartridge
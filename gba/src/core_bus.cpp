@@ -6,6 +6,7 @@
  */
 
 #include <gba/core.h>
+#include <gba/helper/static_for.h>
 
 namespace gba {
 
@@ -14,6 +15,11 @@ u8 core::read_io(const u32 addr) noexcept
     auto& timer_controller = cpu_.timer_controller_;
     auto& dma_controller = cpu_.dma_controller_;
 
+    // timer counters advance without any event firing
+    if(addr >= cpu::addr_tm0cnt_l && addr <= cpu::addr_tm3cnt_h) {
+        cpu_.mark_volatile_read();
+    }
+
     switch(addr.get()) {
         case keypad::addr_state:     return narrow<u8>(keypad_.keyinput_);
         case keypad::addr_state + 1: return narrow<u8>(keypad_.keyinput_ >> 8_u16);
@@ -491,4 +497,286 @@ void core::write_io(const u32 addr, const u8 data) noexcept
     }
 }
 
+const array<core::io_register, core::io_register_count.get()> core::io_registers_ = [] {
+    array<io_register, io_register_count.get()> registers{};
+    const auto reg = [&](const u32 addr) -> io_register& {
+        return registers[usize{(addr & 0x00FF'FFFF_u32) >> 1_u32}];
+    };
+
+    reg(keypad::addr_state).read_16 = {&core::read_keyinput};
+    reg(ppu::addr_dispstat).read_16 = {&core::read_dispstat};
+    reg(ppu::addr_dispstat).write_16 = {&core::write_dispstat};
+    reg(ppu::addr_vcount).read_16 = {&core::read_vcount};
+
+    reg(apu::addr_fifo_a).write_32 = {&core::write_fifo<true>};
+    reg(apu::addr_fifo_b).write_32 = {&core::write_fifo<false>};
+
+    static_for<u32::type, 0, 4>([&](const auto id) {
+        constexpr u32 timer_offset{4 * id};
+        reg(cpu::addr_tm0cnt_l + timer_offset).read_16 = {&core::read_timer_counter<id>};
+        reg(cpu::addr_tm0cnt_l + timer_offset).read_32 = {&core::read_timer<id>};
+        reg(cpu::addr_tm0cnt_l + timer_offset).write_32 = {&core::write_timer<id>};
+
+        constexpr u32 dma_offset{12 * id};
+        reg(cpu::addr_dma0sad + dma_offset).write_32 = {&core::write_dma_address<id>};
+        reg(cpu::addr_dma0dad + dma_offset).write_32 = {&core::write_dma_address<id>};
+        reg(cpu::addr_dma0cnt_l + dma_offset).write_32 = {&core::write_dma_cnt<id>};
+        reg(cpu::addr_dma0cnt_h + dma_offset).write_16 = {&core::write_dma_cnt_h<id>};
+    });
+
+    reg(cpu::addr_ie).read_16 = {&core::read_ie};
+    reg(cpu::addr_ie).write_16 = {&core::write_ie};
+    reg(cpu::addr_if).read_16 = {&core::read_if};
+    reg(cpu::addr_if).write_16 = {&core::write_if};
+    reg(cpu::addr_ime).read_16 = {&core::read_ime};
+    reg(cpu::addr_ime).write_16 = {&core::write_ime};
+    return registers;
+}();
+
+u16 core::read_keyinput(const u32 /*addr*/) noexcept { return keypad_.keyinput_; }
+u16 core::read_vcount(const u32 /*addr*/) noexcept { return ppu_engine_.vcount_; }
+u16 core::read_ie(const u32 /*addr*/) noexcept { return cpu_.ie_; }
+u16 core::read_if(const u32 /*addr*/) noexcept { return cpu_.if_; }
+u16 core::read_ime(const u32 /*addr*/) noexcept { return bit::from_bool<u16>(cpu_.ime_); }
+
+u16 core::read_dispstat(const u32 /*addr*/) noexcept
+{
+    return widen<u16>(ppu_engine_.dispstat_.read_lower()) | widen<u16>(ppu_engine_.dispstat_.read_upper()) << 8_u16;
+}
+
+template<u32::type Id>
+u16 core::read_timer_counter(const u32 /*addr*/) noexcept
+{
+    // timer counters advance without any event firing
+    cpu_.mark_volatile_read();
+    return cpu_.timer_controller_[Id].read_counter();
+}
+
+template<u32::type Id>
+u32 core::read_timer(const u32 addr) noexcept
+{
+    const u16 control = cpu_.timer_controller_[Id].read(timer::register_type::cnt_h_lsb);
+    return widen<u32>(read_timer_counter<Id>(addr)) | widen<u32>(control) << 16_u32;
+}
+
+void core::write_dispstat(const u32 /*addr*/, const u16 data) noexcept
+{
+    ppu_engine_.dispstat_.write_lower(narrow<u8>(data));
+    ppu_engine_.dispstat_.write_upper(narrow<u8>(data >> 8_u16));
+    ppu_engine_.check_vcounter_irq();
+}
+
+void core::write_ie(const u32 /*addr*/, const u16 data) noexcept
+{
+    cpu_.ie_ = data & 0x3FFF_u16;
+    cpu_.schedule_update_irq_signal();
+}
+
+void core::write_if(const u32 /*addr*/, const u16 data) noexcept
+{
+    cpu_.if_ &= ~data;
+    cpu_.schedule_update_irq_signal();
+}
+
+void core::write_ime(const u32 /*addr*/, const u16 data) noexcept
+{
+    cpu_.ime_ = bit::test(data, 0_u8);
+    cpu_.schedule_update_irq_signal();
+}
+
+template<u32::type Id>
+void core::write_dma_cnt_h(const u32 /*addr*/, const u16 data) noexcept
+{
+    cpu_.dma_controller_.write_cnt_l(Id, narrow<u8>(data));
+    cpu_.dma_controller_.write_cnt_h(Id, narrow<u8>(data >> 8_u16));
+}
+
+template<u32::type Id>
+void core::write_dma_address(const u32 addr, const u32 data) noexcept
+{
+    dma::channel& channel = cpu_.dma_controller_[Id];
+    const bool is_dst = addr != cpu::addr_dma0sad + 12_u32 * Id;
+    for(u8 n = 0_u8; n < 4_u8; ++n) {
+        const u8 byte = narrow<u8>(data >> (8_u32 * n));
+        if(is_dst) {
+            channel.write_dst(n, byte);
+        } else {
+            channel.write_src(n, byte);
+        }
+    }
+}
+
+template<u32::type Id>
+void core::write_dma_cnt(const u32 addr, const u32 data) noexcept
+{
+    dma::channel& channel = cpu_.dma_controller_[Id];
+    channel.write_count(0_u8, narrow<u8>(data));
+    channel.write_count(1_u8, narrow<u8>(data >> 8_u32));
+    write_dma_cnt_h<Id>(addr + 2_u32, narrow<u16>(data >> 16_u32));
+}
+
+template<u32::type Id>
+void core::write_timer(const u32 /*addr*/, const u32 data) noexcept
+{
+    // cnt_h_msb is unused
+    timer::timer& t = cpu_.timer_controller_[Id];
+    t.write(timer::register_type::cnt_l_lsb, narrow<u8>(data));
+    t.write(timer::register_type::cnt_l_msb, narrow<u8>(data >> 8_u32));
+    t.write(timer::register_type::cnt_h_lsb, narrow<u8>(data >> 16_u32));
+}
+
+template<bool IsFifoA>
+void core::write_fifo(const u32 /*addr*/, const u32 data) noexcept
+{
+    if constexpr(IsFifoA) {
+        apu_engine_.fifo_a_.write_word(data);
+    } else {
+        apu_engine_.fifo_b_.write_word(data);
+    }
+}
+
+void core::write_sound_fifo(const u32 addr, const view<u8> samples) noexcept
+{
+    if(addr == apu::addr_fifo_a) {
+        apu_engine_.fifo_a_.write_samples(samples);
+    } else {
+        ASSERT(addr == apu::addr_fifo_b);
+        apu_engine_.fifo_b_.write_samples(samples);
+    }
+}
+
+void core::sync_components(const u32 cycles) noexcept
+{
+    scheduler_.add_cycles(pending_cycles_);
+    pending_cycles_ = 0_u32;
+
+    // dma starts before the access which follows its request, as it did when this ran every access
+    if(UNLIKELY(!cpu_.dma_controller_.is_running() && cpu_.dma_controller_.should_start_running())) {
+        cycle_budget_ = 0_u32;
+        cpu_.dma_controller_.run_channels();
+    }
+
+    scheduler_.add_cycles(cycles);
+    sync_cycles();
+}
+
+void core::sync_cycles() noexcept
+{
+    scheduler_.add_cycles(pending_cycles_);
+    pending_cycles_ = 0_u32;
+
+    if(cpu_.dma_controller_.is_running() || cpu_.dma_controller_.should_start_running()) {
+        cycle_budget_ = 0_u32;
+    } else {
+        cycle_budget_ = narrow<u32>(std::min(scheduler_.cycles_before_next_event(), u64{0xFFFF'FFFF_u64}));
+    }
+}
+
+void core::update_page_table() noexcept
+{
+    constexpr u32 region_size = 0x0100'0000_u32;
+    cpu::page_table& pages = cpu_.page_table_;
+
+    pages.map(0x0200'0000_u32, region_size, cpu_.wram_.data(), narrow<u32>(cpu_.wram_.size()), true);
+    pages.map(0x0300'0000_u32, region_size, cpu_.iwram_.data(), narrow<u32>(cpu_.iwram_.size()), true);
+
+    // the ppu tracks every video memory write, keep those on the slow path
+    pages.map(0x0500'0000_u32, region_size, ppu_engine_.palette_ram_.data(), 0x400_u32);
+    pages.map(0x0700'0000_u32, region_size, ppu_engine_.oam_.data(), 0x400_u32);
+
+    // 64K + 32K + 32K mirror repeated every 128K
+    for(u32 addr = 0x0600'0000_u32; addr < 0x0700'0000_u32; addr += 0x2'0000_u32) {
+        pages.map(addr, 0x1'8000_u32, ppu_engine_.vram_.data(), 0x1'8000_u32);
+        pages.map(addr + 0x1'8000_u32, 0x8000_u32, ppu_engine_.vram_.ptr(64_kb), 0x8000_u32);
+    }
+
+    const bool has_eeprom = gamepak_.backup_type() == cartridge::backup::type::eeprom_undetected
+      || gamepak_.backup_type() == cartridge::backup::type::eeprom_64
+      || gamepak_.backup_type() == cartridge::backup::type::eeprom_4;
+    const u32 pak_size = narrow<u32>(gamepak_.pak_data_->size());
+    for(u32 addr = 0x0800'0000_u32; addr < 0x0E00'0000_u32; addr += cpu::page_table::page_size) {
+        const u32 offset = addr & gamepak_.mirror_mask_;
+        const bool gpio = gamepak_.has_rtc_ && offset < cpu::page_table::page_size;
+        const bool eeprom = has_eeprom && addr >= 0x0D00'0000_u32;
+        if(offset + cpu::page_table::page_size > pak_size || gpio || eeprom) {
+            pages.unmap(addr, cpu::page_table::page_size);
+        } else {
+            pages.map(addr, cpu::page_table::page_size, gamepak_.pak_data_->ptr(offset), cpu::page_table::page_size);
+        }
+    }
+}
+
+view<u8> core::readable_memory(const u32 addr) noexcept
+{
+    const auto region = [](const vector<u8>& memory, const usize offset) {
+        return view<u8>{memory.data() + offset.get(), memory.size() - offset};
+    };
+
+    switch(to_enum<cpu::memory_page>(addr >> 24_u32)) {
+        case cpu::memory_page::ewram:
+            return region(cpu_.wram_, addr & 0x0003'FFFF_u32);
+        case cpu::memory_page::iwram:
+            return region(cpu_.iwram_, addr & 0x0000'7FFF_u32);
+        case cpu::memory_page::palette_ram:
+            return region(ppu_engine_.palette_ram_, addr & 0x0000'03FF_u32);
+        case cpu::memory_page::vram: {
+            const u32 offset = detail::adjust_vram_addr(addr);
+            return view<u8>{ppu_engine_.vram_.data() + offset.get(), (offset < 64_kb ? 64_kb : 96_kb) - offset};
+        }
+        case cpu::memory_page::oam_ram:
+            return region(ppu_engine_.oam_, addr & 0x0000'03FF_u32);
+        case cpu::memory_page::pak_ws2_upper:
+            if(detail::is_eeprom(gamepak_.pak_data_->size(), gamepak_.backup_type(), addr)) {
+                return view<u8>{nullptr, 0_usize};
+            }
+            [[fallthrough]];
+        case cpu::memory_page::pak_ws0_lower: case cpu::memory_page::pak_ws0_upper:
+        case cpu::memory_page::pak_ws1_lower: case cpu::memory_page::pak_ws1_upper:
+        case cpu::memory_page::pak_ws2_lower: {
+            const u32 offset = addr & gamepak_.mirror_mask_;
+            if(offset >= gamepak_.pak_data_->size() || (gamepak_.has_rtc_ && offset <= cartridge::rtc::port_control)) {
+                return view<u8>{nullptr, 0_usize};
+            }
+
+            // reads past the mirror wrap around, stop there
+            const usize mirror_end = std::min(gamepak_.pak_data_->size(), usize{gamepak_.mirror_mask_} + 1_usize);
+            return view<u8>{gamepak_.pak_data_->data() + offset.get(), mirror_end - offset};
+        }
+        default:
+            return view<u8>{nullptr, 0_usize};
+    }
+}
+
+u8* core::writable_memory(const u32 addr, const usize size) noexcept
+{
+    const auto region = [size](vector<u8>& memory, const usize offset) -> u8* {
+        return offset + size <= memory.size() ? memory.data() + offset.get() : nullptr;
+    };
+
+    switch(to_enum<cpu::memory_page>(addr >> 24_u32)) {
+        case cpu::memory_page::ewram:
+            return region(cpu_.wram_, addr & 0x0003'FFFF_u32);
+        case cpu::memory_page::iwram:
+            return region(cpu_.iwram_, addr & 0x0000'7FFF_u32);
+        case cpu::memory_page::palette_ram:
+            ppu_engine_.on_palette_write(addr & 0x0000'03FF_u32, size);
+            return region(ppu_engine_.palette_ram_, addr & 0x0000'03FF_u32);
+        case cpu::memory_page::vram: {
+            // 32K mirror breaks contiguity at 64K
+            const u32 offset = detail::adjust_vram_addr(addr);
+            const usize end = offset < 64_kb ? 64_kb : 96_kb;
+            if(offset + size > end) {
+                return nullptr;
+            }
+            ppu_engine_.on_vram_write(offset, size);
+            return ppu_engine_.vram_.data() + offset.get();
+        }
+        case cpu::memory_page::oam_ram:
+            ppu_engine_.on_oam_write(addr & 0x0000'03FF_u32, size);
+            return region(ppu_engine_.oam_, addr & 0x0000'03FF_u32);
+        default:
+            return nullptr;
+    }
+}
+
 } // namespace gba
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <gba/core_pool.h>
+
+namespace gba {
+
+core_pool::core_pool(usize thread_count)
+{
+    if(thread_count == 0_usize) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(thread_count);
+    for(usize i = 0_usize; i < thread_count; ++i) {
+        queues_.push_back(std::make_unique<work_queue>());
+    }
+
+    workers_.reserve(thread_count);
+    for(usize i = 0_usize; i < thread_count; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+core_pool::~core_pool()
+{
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+
+    for(std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+core& core_pool::add(vector<u8> bios)
+{
+    cores_.push_back(std::make_unique<core>(std::move(bios)));
+
+    // instances may run the same rom, each one gets its own backup file and save states
+    core& c = *cores_.back();
+    c.set_save_suffix(fmt::format("{}", cores_.size() - 1_usize));
+    return c;
+}
+
+void core_pool::tick_frames(const u32 frame_count)
+{
+    if(cores_.empty() || frame_count == 0_u32) {
+        return;
+    }
+
+    std::unique_lock lock{mutex_};
+    pending_ = cores_.size().get();
+    frames_per_run_ = frame_count;
+
+    // a worker still draining the previous run might pick these up before it is woken
+    for(usize idx = 0_usize; idx < cores_.size(); ++idx) {
+        work_queue& queue = *queues_[idx % queues_.size()];
+        std::lock_guard queue_lock{queue.mutex};
+        queue.items.push_back(idx);
+    }
+
+    ++generation_;
+    work_available_.notify_all();
+
+    work_done_.wait(lock, [&]() { return pending_ == 0u; });
+}
+
+void core_pool::worker_loop(const usize worker_idx)
+{
+    u64 seen_generation;
+    while(true) {
+        {
+            std::unique_lock lock{mutex_};
+            work_available_.wait(lock, [&]() { return stopping_ || generation_ != seen_generation; });
+            if(stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        drain(worker_idx);
+    }
+}
+
+void core_pool::drain(const usize worker_idx)
+{
+    while(true) {
+        std::optional<usize> idx = pop(worker_idx);
+        if(!idx.has_value()) {
+            idx = steal(worker_idx);
+        }
+
+        if(!idx.has_value()) {
+            return;
+        }
+
+        // written before the item was queued
+        const u32 frame_count = frames_per_run_;
+        core& c = *cores_[*idx];
+        for(u32 frame = 0_u32; frame < frame_count; ++frame) {
+            c.tick_one_frame();
+        }
+
+        if(pending_.fetch_sub(1) == 1u) {
+            std::lock_guard lock{mutex_};
+            work_done_.notify_all();
+        }
+    }
+}
+
+std::optional<usize> core_pool::pop(const usize worker_idx)
+{
+    work_queue& queue = *queues_[worker_idx];
+    std::lock_guard lock{queue.mutex};
+    if(queue.items.empty()) {
+        return std::nullopt;
+    }
+
+    const usize idx = queue.items.front();
+    queue.items.pop_front();
+    return idx;
+}
+
+std::optional<usize> core_pool::steal(const usize worker_idx)
+{
+    for(usize offset = 1_usize; offset < queues_.size(); ++offset) {
+        work_queue& victim = *queues_[(worker_idx + offset) % queues_.size()];
+        std::lock_guard lock{victim.mutex};
+        if(!victim.items.empty()) {
+            const usize idx = victim.items.back();
+            victim.items.pop_back();
+            return idx;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace gba
@@ -29,7 +29,7 @@ arm7tdmi::arm7tdmi(bus_interface* bus, scheduler* scheduler) noexcept
       0xF000'0000_u32
     }
 {
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT(arm7tdmi::update_irq_signal), "arm::update_irq");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT(arm7tdmi::update_irq_signal), "arm::update_irq");
 
     cpsr().mode = privilege_mode::svc;
     switch_mode(cpsr().mode);
@@ -49,18 +49,19 @@ void arm7tdmi::execute_instruction() noexcept
     }
 #endif // WITH_DEBUGGER
 
+    ++executed_instructions_;
     const u32 instruction = pipeline_.executing;
     pipeline_.executing = pipeline_.decoding;
 
     if(cpsr().t) {
         pc() = bit::clear(pc(), 0_u8); // halfword align
-        pipeline_.decoding = bus_->read_16(pc(), pipeline_.fetch_type);
+        pipeline_.decoding = fetch_16(pc(), pipeline_.fetch_type);
         auto func = thumb_table[instruction >> 6_u32];
         ASSERT(func.is_valid());
         func(this, narrow<u16>(instruction));
     } else {
         pc() = mask::clear(pc(), 0b11_u32); // word align
-        pipeline_.decoding = bus_->read_32(pc(), pipeline_.fetch_type);
+        pipeline_.decoding = fetch_32(pc(), pipeline_.fetch_type);
 
         if(condition_met(instruction >> 28_u32)) {
             auto func = arm_table[((instruction >> 16_u32) & 0xFF0_u32) | ((instruction >> 4_u32) & 0xF_u32)];
@@ -73,13 +74,88 @@ void arm7tdmi::execute_instruction() noexcept
     }
 }
 
+void arm7tdmi::track_idle_loop(const u32 branch_addr, const bool thumb) noexcept
+{
+    // only a single iteration of the loop may have run since the last time, nothing else
+    const bool consecutive = branch_addr == idle_loop_.branch_addr
+      && idle_loop_.flush_count == idle_loop_.tracked_flush_count + 1_u32;
+
+    if(!consecutive) {
+        idle_loop_.branch_addr = branch_addr;
+        idle_loop_.body_idle = is_idle_loop_body(pc(), branch_addr, thumb);
+    } else if(idle_loop_.body_idle && !idle_loop_.volatile_read && !(irq_signal_ && !cpsr().i)) {
+        bool same_state = idle_loop_.cpsr == static_cast<u32>(cpsr());
+        for(u32 r = 0_u32; same_state && r < 15_u32; ++r) {
+            same_state = idle_loop_.regs[r] == r_[r];
+        }
+        idle_loop_.detected = same_state;
+    }
+
+    for(u32 r = 0_u32; r < 15_u32; ++r) {
+        idle_loop_.regs[r] = r_[r];
+    }
+    idle_loop_.cpsr = static_cast<u32>(cpsr());
+    idle_loop_.tracked_flush_count = idle_loop_.flush_count;
+    idle_loop_.volatile_read = false;
+}
+
+bool arm7tdmi::is_idle_loop_body(const u32 begin, const u32 end, const bool thumb) noexcept
+{
+    // only loads and register operations, anything which writes memory or leaves the loop is rejected
+    if(thumb) {
+        for(u32 addr = begin; addr < end; addr += 2_u32) {
+            const u32 instr = bus_->read_16(addr, mem_access::none);
+            const bool allowed = (instr & 0xC000_u32) == 0x0000_u32  // move shifted, add/sub, mov/cmp/add/sub imm
+              || (instr & 0xFC00_u32) == 0x4000_u32                  // alu
+              || (instr & 0xFF00_u32) == 0x4500_u32                  // hireg cmp
+              || (instr & 0xF800_u32) == 0x4800_u32                  // pc relative load
+              || ((instr & 0xF000_u32) == 0x5000_u32 && (instr & 0x0800_u32) != 0_u32) // ldr, ldrb, ldrh, ldsh
+              || (instr & 0xFE00_u32) == 0x5600_u32                  // ldsb
+              || ((instr & 0xE000_u32) == 0x6000_u32 && (instr & 0x0800_u32) != 0_u32) // ldr, ldrb imm
+              || ((instr & 0xF000_u32) == 0x8000_u32 && (instr & 0x0800_u32) != 0_u32) // ldrh imm
+              || ((instr & 0xF000_u32) == 0x9000_u32 && (instr & 0x0800_u32) != 0_u32) // ldr sp relative
+              || (instr & 0xF000_u32) == 0xA000_u32;                 // add to pc/sp
+            if(!allowed) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for(u32 addr = begin; addr < end; addr += 4_u32) {
+        const u32 instr = bus_->read_32(addr, mem_access::none);
+        const u32 rd = (instr >> 12_u32) & 0xF_u32;
+        const u32 alu_opcode = (instr >> 21_u32) & 0xF_u32;
+
+        bool allowed;
+        if((instr & 0x0C10'0000_u32) == 0x0410'0000_u32) { // ldr, ldrb
+            allowed = rd != 15_u32;
+        } else if((instr & 0x0E10'0090_u32) == 0x0010'0090_u32 && (instr & 0x0000'0060_u32) != 0_u32) { // ldrh, ldrsb, ldrsh
+            allowed = rd != 15_u32;
+        } else if((instr & 0x0E00'0000_u32) == 0x0200'0000_u32 // data processing with immediate
+          || (instr & 0x0E00'0010_u32) == 0x0000'0000_u32      // data processing with immediate shift
+          || (instr & 0x0E00'0090_u32) == 0x0000'0010_u32) {   // data processing with register shift
+            // tst/teq/cmp/cmn without the S bit are psr transfers and bx
+            const bool is_test = alu_opcode >= 0x8_u32 && alu_opcode <= 0xB_u32;
+            allowed = is_test ? bit::test(instr, 20_u8) : rd != 15_u32;
+        } else {
+            allowed = false;
+        }
+
+        if(!allowed) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void arm7tdmi::schedule_update_irq_signal() noexcept
 {
     scheduled_irq_signal_ = ime_ && interrupt_available();
 
     if(scheduled_irq_signal_ != irq_signal_) {
         scheduler_->remove_event(irq_signal_delay_handle_);
-        irq_signal_delay_handle_ = scheduler_->add_hw_event(1_u32, MAKE_HW_EVENT(arm7tdmi::update_irq_signal));
+        irq_signal_delay_handle_ = scheduler_->add_hw_event(scheduler::event_source::irq, 1_u32, MAKE_HW_EVENT(arm7tdmi::update_irq_signal));
     }
 }
 
@@ -141,20 +217,20 @@ bool arm7tdmi::condition_met(const u32 cond) const noexcept
     }
 
     switch(cond.get()) {
-        /* EQ */ case 0x0: return cpsr_.z;
-        /* NE */ case 0x1: return !cpsr_.z;
-        /* CS */ case 0x2: return cpsr_.c;
-        /* CC */ case 0x3: return !cpsr_.c;
-        /* MI */ case 0x4: return cpsr_.n;
-        /* PL */ case 0x5: return !cpsr_.n;
-        /* VS */ case 0x6: return cpsr_.v;
-        /* VC */ case 0x7: return !cpsr_.v;
-        /* HI */ case 0x8: return cpsr_.c && !cpsr_.z;
-        /* LS */ case 0x9: return !cpsr_.c || cpsr_.z;
-        /* GE */ case 0xA: return cpsr_.n == cpsr_.v;
-        /* LT */ case 0xB: return cpsr_.n != cpsr_.v;
-        /* GT */ case 0xC: return !cpsr_.z && cpsr_.n == cpsr_.v;
-        /* LE */ case 0xD: return cpsr_.z || cpsr_.n != cpsr_.v;
+        /* EQ */ case 0x0: return cpsr_.z();
+        /* NE */ case 0x1: return !cpsr_.z();
+        /* CS */ case 0x2: return cpsr_.c();
+        /* CC */ case 0x3: return !cpsr_.c();
+        /* MI */ case 0x4: return cpsr_.n();
+        /* PL */ case 0x5: return !cpsr_.n();
+        /* VS */ case 0x6: return cpsr_.v();
+        /* VC */ case 0x7: return !cpsr_.v();
+        /* HI */ case 0x8: return cpsr_.c() && !cpsr_.z();
+        /* LS */ case 0x9: return !cpsr_.c() || cpsr_.z();
+        /* GE */ case 0xA: return cpsr_.n() == cpsr_.v();
+        /* LT */ case 0xB: return cpsr_.n() != cpsr_.v();
+        /* GT */ case 0xC: return !cpsr_.z() && cpsr_.n() == cpsr_.v();
+        /* LE */ case 0xD: return cpsr_.z() || cpsr_.n() != cpsr_.v();
     }
 
     // NV
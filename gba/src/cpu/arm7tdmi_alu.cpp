@@ -111,57 +111,38 @@ void arm7tdmi::alu_ror(u32& operand, u8 shift_amount, bool& carry, const bool im
 
 u32 arm7tdmi::alu_add(const u32 first_op, const u32 second_op, const bool set_flags) noexcept
 {
+    const u32 result = first_op + second_op;
     if(set_flags) {
-        const u64 result = widen<u64>(first_op) + second_op;
-        const u32 result32 = narrow<u32>(result);
-
-        cpsr().n = bit::test(result32, 31_u8);
-        cpsr().z = result32 == 0_u32;
-        cpsr().c = bit::test(result, 32_u8);
-        cpsr().v = bit::test(~(first_op ^ second_op) & (second_op ^ result32), 31_u8);
-        return result32;
+        cpsr().set_add(first_op, second_op, false, result);
     }
-
-    return first_op + second_op;
+    return result;
 }
 
 u32 arm7tdmi::alu_adc(const u32 first_op, const u32 second_op, const bool set_flags) noexcept
 {
+    const bool carry = cpsr().c();
+    const u32 result = first_op + second_op + bit::from_bool(carry);
     if(set_flags) {
-        const u64 result = widen<u64>(first_op) + second_op + bit::from_bool(cpsr().c);
-        const u32 result32 = narrow<u32>(result);
-
-        cpsr().n = bit::test(result32, 31_u8);
-        cpsr().z = result32 == 0_u32;
-        cpsr().c = bit::test(result, 32_u8);
-        cpsr().v = bit::test(~(first_op ^ second_op) & (second_op ^ result32), 31_u8);
-        return result32;
+        cpsr().set_add(first_op, second_op, carry, result);
     }
-
-    return first_op + second_op + bit::from_bool(cpsr().c);
+    return result;
 }
 
 u32 arm7tdmi::alu_sub(const u32 first_op, const u32 second_op, const bool set_flags) noexcept
 {
     const u32 result = first_op - second_op;
     if(set_flags) {
-        cpsr().n = bit::test(result, 31_u8);
-        cpsr().z = result == 0_u32;
-        cpsr().c = first_op >= second_op;
-        cpsr().v = bit::test((first_op ^ second_op) & (first_op ^ result), 31_u8);
+        cpsr().set_sub(first_op, second_op, true, result);
     }
     return result;
 }
 
 u32 arm7tdmi::alu_sbc(const u32 first_op, const u32 second_op, const bool set_flags) noexcept
 {
-    const u32 borrow = bit::from_bool(!cpsr().c);
-    const u32 result = first_op - second_op - borrow;
+    const bool carry = cpsr().c();
+    const u32 result = first_op - second_op - bit::from_bool(!carry);
     if(set_flags) {
-        cpsr().n = bit::test(result, 31_u8);
-        cpsr().z = result == 0_u32;
-        cpsr().c = first_op >= widen<u64>(second_op) + borrow;
-        cpsr().v = bit::test((first_op ^ second_op) & (first_op ^ result), 31_u8);
+        cpsr().set_sub(first_op, second_op, carry, result);
     }
     return result;
 }
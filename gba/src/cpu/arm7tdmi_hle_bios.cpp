@@ -0,0 +1,722 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <gba/cpu/arm7tdmi.h>
+
+namespace gba::cpu {
+
+namespace {
+
+constexpr u32 irq_handler_addr = 0x0000'0128_u32;
+constexpr u32 intr_wait_addr = 0x0000'0140_u32;
+
+constexpr u32 addr_ime = 0x0400'0208_u32;
+constexpr u32 addr_haltcnt = 0x0400'0301_u32;
+
+constexpr float pi = 3.14159265358979323846f;
+
+/*
+ * Only the parts of the bios which have to run as guest code: exception vectors,
+ * the irq dispatcher which calls the user handler at [0x03007FFC] and IntrWait,
+ * which needs interrupts to be serviced while it waits.
+ */
+constexpr array<u32, 8> hle_vectors{
+  0xE3A0'F302_u32, // 0x00: mov pc, #0x08000000
+  0xE1B0'F00E_u32, // 0x04: movs pc, lr
+  0xEA00'004C_u32, // 0x08: b intr_wait
+  0xE25E'F004_u32, // 0x0C: subs pc, lr, #4
+  0xE25E'F008_u32, // 0x10: subs pc, lr, #8
+  0xE1A0'0000_u32, // 0x14: nop
+  0xEA00'0042_u32, // 0x18: b irq_handler
+  0xE25E'F004_u32, // 0x1C: subs pc, lr, #4
+};
+
+constexpr array<u32, 6> hle_irq_handler{
+  0xE92D'500F_u32, // stmfd sp!, {r0-r3, r12, lr}
+  0xE3A0'0301_u32, // mov r0, #0x04000000
+  0xE28F'E000_u32, // add lr, pc, #0
+  0xE510'F004_u32, // ldr pc, [r0, #-4]
+  0xE8BD'500F_u32, // ldmfd sp!, {r0-r3, r12, lr}
+  0xE25E'F004_u32, // subs pc, lr, #4
+};
+
+// r0: discard old flags, r1: flags to wait for
+constexpr array<u32, 19> hle_intr_wait{
+  0xE92D'500C_u32, //       stmfd sp!, {r2, r3, r12, lr}
+  0xE3A0'C301_u32, //       mov r12, #0x04000000
+  0xE3A0'2001_u32, //       mov r2, #1
+  0xE5CC'2208_u32, //       strb r2, [r12, #0x208]  ; IME
+  0xE350'0000_u32, //       cmp r0, #0
+  0x115C'30B8_u32, //       ldrneh r3, [r12, #-8]   ; [0x03007FF8] irq flags
+  0x11C3'3001_u32, //       bicne r3, r3, r1
+  0x114C'30B8_u32, //       strneh r3, [r12, #-8]
+  0xE3A0'2000_u32, //       mov r2, #0
+  0xE5CC'2301_u32, // wait: strb r2, [r12, #0x301]  ; HALTCNT
+  0xE321'F013_u32, //       msr cpsr_c, #0x13
+  0xE321'F093_u32, //       msr cpsr_c, #0x93
+  0xE15C'30B8_u32, //       ldrh r3, [r12, #-8]
+  0xE013'0001_u32, //       ands r0, r3, r1
+  0x0AFF'FFF9_u32, //       beq wait
+  0xE1C3'3001_u32, //       bic r3, r3, r1
+  0xE14C'30B8_u32, //       strh r3, [r12, #-8]
+  0xE8BD'500C_u32, //       ldmfd sp!, {r2, r3, r12, lr}
+  0xE1B0'F00E_u32, //       movs pc, lr
+};
+
+template<typename Container>
+void copy_code(vector<u8>& bios, u32 addr, const Container& code) noexcept
+{
+    for(const u32 instr : code) {
+        memcpy(bios, addr, instr);
+        addr += 4_u32;
+    }
+}
+
+[[nodiscard]] i32 arctan(const i32 i) noexcept
+{
+    const i32 a = -((i * i) >> 14_i32);
+    i32 b = ((0xA9_i32 * a) >> 14_i32) + 0x390_i32;
+    b = ((b * a) >> 14_i32) + 0x91C_i32;
+    b = ((b * a) >> 14_i32) + 0xFB6_i32;
+    b = ((b * a) >> 14_i32) + 0x16AA_i32;
+    b = ((b * a) >> 14_i32) + 0x2081_i32;
+    b = ((b * a) >> 14_i32) + 0x3651_i32;
+    b = ((b * a) >> 14_i32) + 0xA2F9_i32;
+    return (i * b) >> 16_i32;
+}
+
+[[nodiscard]] i32 arctan2(const i32 x, const i32 y) noexcept
+{
+    if(y == 0_i32) {
+        return x >= 0_i32 ? 0_i32 : 0x8000_i32;
+    }
+    if(x == 0_i32) {
+        return y >= 0_i32 ? 0x4000_i32 : 0xC000_i32;
+    }
+
+    if(y >= 0_i32) {
+        if(x >= 0_i32) {
+            if(x >= y) {
+                return arctan((y << 14_i32) / x);
+            }
+        } else if(-x >= y) {
+            return arctan((y << 14_i32) / x) + 0x8000_i32;
+        }
+        return 0x4000_i32 - arctan((x << 14_i32) / y);
+    }
+
+    if(x <= 0_i32) {
+        if(-x > -y) {
+            return arctan((y << 14_i32) / x) + 0x8000_i32;
+        }
+    } else if(x >= -y) {
+        return arctan((y << 14_i32) / x) + 0x10000_i32;
+    }
+    return 0xC000_i32 - arctan((x << 14_i32) / y);
+}
+
+[[nodiscard]] float to_angle(const u16 angle) noexcept
+{
+    return static_cast<float>((angle >> 8_u16).get()) / 128.f * pi;
+}
+
+[[nodiscard]] u32 to_fixed(const float value) noexcept
+{
+    return make_unsigned(i32{static_cast<i32::type>(value * 256.f)});
+}
+
+// reads straight from host memory when the source allows it and charges the cycles in one go
+class source_reader {
+    bus_interface* bus_;
+    view<u8> memory_;
+    u32 base_;
+    u32 byte_reads_;
+    u32 word_reads_;
+
+public:
+    source_reader(bus_interface* bus, const u32 base) noexcept
+      : bus_{bus},
+        memory_{bus->readable_memory(base)},
+        base_{base} {}
+
+    ~source_reader() noexcept
+    {
+        bus_->tick_burst_16(base_, byte_reads_);
+        bus_->tick_burst_32(base_, word_reads_);
+    }
+
+    source_reader(const source_reader&) = delete;
+    source_reader& operator=(const source_reader&) = delete;
+
+    [[nodiscard]] u8 read_8(const u32 addr) noexcept
+    {
+        if(const usize offset{addr - base_}; LIKELY(offset < memory_.size())) {
+            ++byte_reads_;
+            return memory_[offset];
+        }
+        return bus_->read_8(addr, mem_access::seq);
+    }
+
+    [[nodiscard]] u32 read_32(const u32 addr) noexcept
+    {
+        if(const usize offset{addr - base_}; LIKELY(offset + 4_usize <= memory_.size())) {
+            ++word_reads_;
+            return memcpy<u32>(memory_, offset);
+        }
+        return bus_->read_32(addr, mem_access::seq);
+    }
+};
+
+} // namespace
+
+vector<u8> arm7tdmi::make_hle_bios() noexcept
+{
+    vector<u8> bios{16_kb};
+    copy_code(bios, 0x0000'0000_u32, hle_vectors);
+    copy_code(bios, irq_handler_addr, hle_irq_handler);
+    copy_code(bios, intr_wait_addr, hle_intr_wait);
+    return bios;
+}
+
+bool arm7tdmi::execute_hle_swi(const u8 number) noexcept
+{
+    LOG_TRACE(arm, "hle swi {:02X}", number);
+
+    switch(number.get()) {
+        case 0x00: // SoftReset
+            hle_soft_reset();
+            return true;
+        case 0x01: hle_register_ram_reset(); break;
+        case 0x02: bus_->write_8(addr_haltcnt, 0x00_u8, mem_access::non_seq); break;
+        case 0x03: bus_->write_8(addr_haltcnt, 0x80_u8, mem_access::non_seq); break;
+        case 0x04: // IntrWait
+            return false;
+        case 0x05: // VBlankIntrWait
+            r_[0_u32] = 1_u32;
+            r_[1_u32] = 1_u32;
+            return false;
+        case 0x06: hle_div(make_signed(r_[0_u32]), make_signed(r_[1_u32])); break;
+        case 0x07: hle_div(make_signed(r_[1_u32]), make_signed(r_[0_u32])); break;
+        case 0x08: hle_sqrt(); break;
+        case 0x09:
+            r_[0_u32] = make_unsigned(arctan(math::sign_extend<16>(r_[0_u32])));
+            break;
+        case 0x0A:
+            r_[0_u32] = make_unsigned(arctan2(math::sign_extend<16>(r_[0_u32]), math::sign_extend<16>(r_[1_u32]))) & 0xFFFF_u32;
+            break;
+        case 0x0B: hle_cpu_set(); break;
+        case 0x0C: hle_cpu_fast_set(); break;
+        case 0x0D: r_[0_u32] = 0xBAAE'187F_u32; break; // GetBiosChecksum
+        case 0x0E: hle_bg_affine_set(); break;
+        case 0x0F: hle_obj_affine_set(); break;
+        case 0x10: hle_write_uncompressed<u32>(hle_bit_unpack()); break;
+        case 0x11: hle_write_uncompressed<u8>(hle_lz77_uncomp()); break;
+        case 0x12: hle_write_uncompressed<u16>(hle_lz77_uncomp()); break;
+        case 0x13: hle_write_uncompressed<u32>(hle_huff_uncomp()); break;
+        case 0x14: hle_write_uncompressed<u8>(hle_rl_uncomp()); break;
+        case 0x15: hle_write_uncompressed<u16>(hle_rl_uncomp()); break;
+        case 0x16: hle_write_uncompressed<u8>(hle_diff_unfilter<u8>()); break;
+        case 0x17: hle_write_uncompressed<u16>(hle_diff_unfilter<u8>()); break;
+        case 0x18: hle_write_uncompressed<u16>(hle_diff_unfilter<u16>()); break;
+        case 0x19: hle_sound_bias(); break;
+        case 0x1F: hle_midi_key_to_freq(); break;
+        case 0x25: // MultiBoot, there is no link cable to boot through
+            r_[0_u32] = 1_u32;
+            break;
+        case 0x27: bus_->write_8(addr_haltcnt, narrow<u8>(r_[2_u32]), mem_access::non_seq); break; // CustomHalt
+        default:
+            // the sound driver and the reset functions need the real bios code, skip the call
+            LOG_WARN(arm, "hle bios does not implement swi {:02X}, a bios dump is needed", number);
+            break;
+    }
+
+    pipeline_.fetch_type = mem_access::seq;
+    pc() += cpsr().t ? 2_u32 : 4_u32;
+    return true;
+}
+
+void arm7tdmi::hle_soft_reset() noexcept
+{
+    // the return address flag is kept in the area that is about to be cleared
+    const bool return_to_ram = bus_->read_8(0x0300'7FFA_u32, mem_access::non_seq) != 0_u8;
+    if(u8* stack_area = bus_->writable_memory(0x0300'7E00_u32, 0x200_usize)) {
+        std::fill_n(stack_area, 0x200, 0_u8);
+    }
+
+    cpsr().t = false;
+    switch_mode(privilege_mode::sys);
+    for(u32 i = 0_u32; i < 13_u32; ++i) {
+        r_[i] = 0_u32;
+    }
+    reg_banks_[register_bank::irq].named.r13 = 0x0300'7FA0_u32;
+    reg_banks_[register_bank::irq].named.r14 = 0_u32;
+    reg_banks_[register_bank::svc].named.r13 = 0x0300'7FE0_u32;
+    reg_banks_[register_bank::svc].named.r14 = 0_u32;
+    spsr_banks_[register_bank::irq] = psr{};
+    spsr_banks_[register_bank::svc] = psr{};
+
+    sp() = 0x0300'7F00_u32;
+    pc() = return_to_ram ? 0x0200'0000_u32 : 0x0800'0000_u32;
+    lr() = pc();
+    pipeline_flush<instruction_mode::arm>();
+}
+
+void arm7tdmi::hle_register_ram_reset() noexcept
+{
+    const u32 flags = r_[0_u32];
+    const auto clear = [&](const u32 addr, const usize size) {
+        if(u8* memory = bus_->writable_memory(addr, size)) {
+            std::fill_n(memory, size.get(), 0_u8);
+        }
+    };
+
+    if(bit::test(flags, 0_u8)) { clear(0x0200'0000_u32, 256_kb); }
+    if(bit::test(flags, 1_u8)) { clear(0x0300'0000_u32, 32_kb - 0x200_usize); } // bios stack area is kept
+    if(bit::test(flags, 2_u8)) { clear(0x0500'0000_u32, 1_kb); }
+    if(bit::test(flags, 3_u8)) { clear(0x0600'0000_u32, 96_kb); }
+    if(bit::test(flags, 4_u8)) { clear(0x0700'0000_u32, 1_kb); }
+    if((flags & 0xE0_u32) != 0_u32) {
+        LOG_DEBUG(arm, "hle RegisterRamReset ignores io register reset flags {:02X}", flags & 0xE0_u32);
+    }
+}
+
+void arm7tdmi::hle_div(const i32 numerator, const i32 denominator) noexcept
+{
+    if(UNLIKELY(denominator == 0_i32)) {
+        LOG_WARN(arm, "hle Div by zero");
+        r_[0_u32] = numerator < 0_i32 ? 0xFFFF'FFFF_u32 : 1_u32;
+        r_[1_u32] = make_unsigned(numerator);
+        r_[3_u32] = 1_u32;
+        return;
+    }
+
+    // INT_MIN / -1 overflows on the host, the bios returns INT_MIN
+    const i64 quotient = widen<i64>(numerator) / widen<i64>(denominator);
+    r_[0_u32] = narrow<u32>(make_unsigned(quotient));
+    r_[1_u32] = make_unsigned(narrow<i32>(widen<i64>(numerator) % widen<i64>(denominator)));
+    r_[3_u32] = narrow<u32>(make_unsigned(quotient < 0_i64 ? -quotient : quotient));
+}
+
+void arm7tdmi::hle_sqrt() noexcept
+{
+    u32 value = r_[0_u32];
+    u32 result;
+    u32 bit = 1_u32 << 30_u32;
+
+    while(bit > value) {
+        bit >>= 2_u32;
+    }
+
+    while(bit != 0_u32) {
+        if(value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1_u32) + bit;
+        } else {
+            result >>= 1_u32;
+        }
+        bit >>= 2_u32;
+    }
+
+    r_[0_u32] = result;
+}
+
+void arm7tdmi::hle_cpu_set() noexcept
+{
+    const u32 control = r_[2_u32];
+    const u32 count = control & 0x001F'FFFF_u32;
+    const bool fill = bit::test(control, 24_u8);
+
+    if(bit::test(control, 26_u8)) {
+        hle_transfer<u32>(mask::clear(r_[0_u32], 0b11_u32), mask::clear(r_[1_u32], 0b11_u32), count, fill);
+    } else {
+        hle_transfer<u16>(bit::clear(r_[0_u32], 0_u8), bit::clear(r_[1_u32], 0_u8), count, fill);
+    }
+}
+
+void arm7tdmi::hle_cpu_fast_set() noexcept
+{
+    const u32 control = r_[2_u32];
+
+    // transfers in blocks of 8 words
+    const u32 count = ((control & 0x001F'FFFF_u32) + 7_u32) & ~7_u32;
+    hle_transfer<u32>(mask::clear(r_[0_u32], 0b11_u32), mask::clear(r_[1_u32], 0b11_u32), count, bit::test(control, 24_u8));
+}
+
+template<typename T>
+void arm7tdmi::hle_transfer(const u32 src, const u32 dst, const u32 count, const bool fill) noexcept
+{
+    if(count == 0_u32) {
+        return;
+    }
+
+    const usize size{count * sizeof(T)};
+    const view<u8> source = bus_->readable_memory(src);
+    u8* destination = bus_->writable_memory(dst, size);
+    const usize read_size = fill ? usize{sizeof(T)} : size;
+
+    // overlapping copies must see their own writes, leave them to the slow path
+    const bool overlaps = !fill && dst > src && dst - src < size;
+    if(destination && source.size() >= read_size && !overlaps) {
+        if(fill) {
+            const T value = memcpy<T>(source, 0_usize);
+            for(usize offset; offset < size; offset += sizeof(T)) {
+                std::memcpy(destination + offset.get(), &value, sizeof(T));
+            }
+        } else {
+            std::memmove(destination, source.data(), size.get());
+        }
+
+        if constexpr(std::is_same_v<T, u32>) {
+            bus_->tick_burst_32(src, fill ? 1_u32 : count);
+            bus_->tick_burst_32(dst, count);
+        } else {
+            bus_->tick_burst_16(src, fill ? 1_u32 : count);
+            bus_->tick_burst_16(dst, count);
+        }
+        return;
+    }
+
+    const auto read = [&](const u32 addr, const mem_access access) -> T {
+        if constexpr(std::is_same_v<T, u32>) {
+            return bus_->read_32(addr, access);
+        } else {
+            return bus_->read_16(addr, access);
+        }
+    };
+    const auto write = [&](const u32 addr, const T data, const mem_access access) {
+        if constexpr(std::is_same_v<T, u32>) {
+            bus_->write_32(addr, data, access);
+        } else {
+            bus_->write_16(addr, data, access);
+        }
+    };
+
+    constexpr u32 unit_size = narrow<u32>(usize{sizeof(T)});
+    mem_access access = mem_access::non_seq;
+    const T fill_value = fill ? read(src, access) : T{};
+    for(u32 i = 0_u32; i < count; ++i) {
+        const T data = fill ? fill_value : read(src + i * unit_size, access);
+        write(dst + i * unit_size, data, access);
+        access = mem_access::seq;
+    }
+}
+
+void arm7tdmi::hle_bg_affine_set() noexcept
+{
+    u32 src = r_[0_u32];
+    u32 dst = r_[1_u32];
+
+    for(u32 i = 0_u32; i < r_[2_u32]; ++i, src += 20_u32, dst += 16_u32) {
+        const float origin_x = static_cast<float>(make_signed(bus_->read_32(src, mem_access::non_seq)).get()) / 256.f;
+        const float origin_y = static_cast<float>(make_signed(bus_->read_32(src + 4_u32, mem_access::seq)).get()) / 256.f;
+        const float display_x = static_cast<float>(make_signed(bus_->read_16(src + 8_u32, mem_access::seq)).get());
+        const float display_y = static_cast<float>(make_signed(bus_->read_16(src + 10_u32, mem_access::seq)).get());
+        const float scale_x = static_cast<float>(make_signed(bus_->read_16(src + 12_u32, mem_access::seq)).get()) / 256.f;
+        const float scale_y = static_cast<float>(make_signed(bus_->read_16(src + 14_u32, mem_access::seq)).get()) / 256.f;
+        const float angle = to_angle(bus_->read_16(src + 16_u32, mem_access::seq));
+
+        const float pa = std::cos(angle) * scale_x;
+        const float pb = -std::sin(angle) * scale_x;
+        const float pc = std::sin(angle) * scale_y;
+        const float pd = std::cos(angle) * scale_y;
+
+        bus_->write_16(dst, narrow<u16>(to_fixed(pa)), mem_access::non_seq);
+        bus_->write_16(dst + 2_u32, narrow<u16>(to_fixed(pb)), mem_access::seq);
+        bus_->write_16(dst + 4_u32, narrow<u16>(to_fixed(pc)), mem_access::seq);
+        bus_->write_16(dst + 6_u32, narrow<u16>(to_fixed(pd)), mem_access::seq);
+        bus_->write_32(dst + 8_u32, to_fixed(origin_x - (pa * display_x + pb * display_y)), mem_access::seq);
+        bus_->write_32(dst + 12_u32, to_fixed(origin_y - (pc * display_x + pd * display_y)), mem_access::seq);
+    }
+}
+
+void arm7tdmi::hle_obj_affine_set() noexcept
+{
+    u32 src = r_[0_u32];
+    u32 dst = r_[1_u32];
+    const u32 stride = r_[3_u32];
+
+    for(u32 i = 0_u32; i < r_[2_u32]; ++i, src += 8_u32, dst += stride * 4_u32) {
+        const float scale_x = static_cast<float>(make_signed(bus_->read_16(src, mem_access::non_seq)).get()) / 256.f;
+        const float scale_y = static_cast<float>(make_signed(bus_->read_16(src + 2_u32, mem_access::seq)).get()) / 256.f;
+        const float angle = to_angle(bus_->read_16(src + 4_u32, mem_access::seq));
+
+        bus_->write_16(dst, narrow<u16>(to_fixed(std::cos(angle) * scale_x)), mem_access::non_seq);
+        bus_->write_16(dst + stride, narrow<u16>(to_fixed(-std::sin(angle) * scale_x)), mem_access::non_seq);
+        bus_->write_16(dst + stride * 2_u32, narrow<u16>(to_fixed(std::sin(angle) * scale_y)), mem_access::non_seq);
+        bus_->write_16(dst + stride * 3_u32, narrow<u16>(to_fixed(std::cos(angle) * scale_y)), mem_access::non_seq);
+    }
+}
+
+void arm7tdmi::hle_sound_bias() noexcept
+{
+    // the bios steps the level one unit at a time, r1 apart
+    constexpr u32 addr_soundbias = 0x0400'0088_u32;
+    const u16 bias = bus_->read_16(addr_soundbias, mem_access::non_seq);
+    const u16 level = r_[0_u32] == 0_u32 ? 0x000_u16 : 0x200_u16;
+    bus_->write_16(addr_soundbias, mask::clear(bias, 0x3FF_u16) | level, mem_access::non_seq);
+}
+
+void arm7tdmi::hle_midi_key_to_freq() noexcept
+{
+    const u32 frequency = bus_->read_32(r_[0_u32] + 4_u32, mem_access::non_seq);
+    const double key = static_cast<double>((r_[1_u32] & 0xFF_u32).get());
+    const double fine_adjust = static_cast<double>((r_[2_u32] & 0xFF_u32).get()) / 256.0;
+    r_[0_u32] = u32{static_cast<u32::type>(static_cast<double>(frequency.get()) / std::exp2((180.0 - key - fine_adjust) / 12.0))};
+}
+
+vector<u8> arm7tdmi::hle_bit_unpack() noexcept
+{
+    const u32 info = r_[2_u32];
+    const u32 src_length = widen<u32>(bus_->read_16(info, mem_access::non_seq));
+    const u32 src_width = widen<u32>(bus_->read_8(info + 2_u32, mem_access::seq));
+    const u32 dst_width = widen<u32>(bus_->read_8(info + 3_u32, mem_access::seq));
+    const u32 data_offset = bus_->read_32(info + 4_u32, mem_access::seq);
+
+    const auto valid_width = [](const u32 width, const u32 max_width) {
+        return width != 0_u32 && width <= max_width && (width & (width - 1_u32)) == 0_u32;
+    };
+    if(!valid_width(src_width, 8_u32) || !valid_width(dst_width, 32_u32)) {
+        LOG_WARN(arm, "hle BitUnPack invalid widths {} -> {}", src_width, dst_width);
+        return {};
+    }
+
+    // bit 31 adds the offset to zero units as well
+    const bool offset_zeroes = bit::test(data_offset, 31_u8);
+    const u32 offset = bit::clear(data_offset, 31_u8);
+    const u32 src_mask = (1_u32 << src_width) - 1_u32;
+
+    u32 src = r_[0_u32];
+    source_reader reader{bus_, src};
+
+    // output is written in words
+    vector<u8> out{usize{src_length * (8_u32 / src_width) * dst_width / 32_u32 * 4_u32}};
+    usize cursor;
+    u32 block;
+    u32 bits_seen;
+    for(u32 i = 0_u32; i < src_length; ++i) {
+        const u32 byte = widen<u32>(reader.read_8(src++));
+        for(u32 shift = 0_u32; shift < 8_u32; shift += src_width) {
+            u32 data = (byte >> shift) & src_mask;
+            if(data != 0_u32 || offset_zeroes) {
+                data += offset;
+            }
+
+            block |= data << bits_seen;
+            bits_seen += dst_width;
+            if(bits_seen == 32_u32) {
+                memcpy(out, cursor, block);
+                cursor += 4_usize;
+                block = 0_u32;
+                bits_seen = 0_u32;
+            }
+        }
+    }
+
+    return out;
+}
+
+template<typename T>
+vector<u8> arm7tdmi::hle_diff_unfilter() noexcept
+{
+    u32 src = r_[0_u32];
+    source_reader reader{bus_, src};
+    const usize size{reader.read_32(src) >> 8_u32};
+    src += 4_u32;
+
+    // every unit is stored as the difference to the previous one
+    vector<u8> out{size};
+    T unit;
+    for(usize cursor; cursor + sizeof(T) <= size; cursor += sizeof(T)) {
+        if constexpr(std::is_same_v<T, u16>) {
+            unit += widen<u16>(reader.read_8(src)) | (widen<u16>(reader.read_8(src + 1_u32)) << 8_u16);
+        } else {
+            unit += reader.read_8(src);
+        }
+        src += narrow<u32>(usize{sizeof(T)});
+        memcpy(out, cursor, unit);
+    }
+
+    return out;
+}
+
+vector<u8> arm7tdmi::hle_lz77_uncomp() noexcept
+{
+    u32 src = r_[0_u32];
+    source_reader reader{bus_, src};
+    const usize size{reader.read_32(src) >> 8_u32};
+    src += 4_u32;
+
+    vector<u8> out{size};
+    usize cursor;
+    while(cursor < size) {
+        const u8 flags = reader.read_8(src++);
+        for(u8 i = 0_u8; i < 8_u8 && cursor < size; ++i) {
+            if(!bit::test(flags, 7_u8 - i)) {
+                out[cursor++] = reader.read_8(src++);
+                continue;
+            }
+
+            const u8 b0 = reader.read_8(src++);
+            const u8 b1 = reader.read_8(src++);
+            const usize length = std::min(widen<usize>(b0 >> 4_u8) + 3_usize, size - cursor);
+            const usize displacement = ((widen<usize>(b0 & 0x0F_u8) << 8_usize) | b1) + 1_usize;
+            if(UNLIKELY(displacement > cursor)) {
+                LOG_WARN(arm, "hle LZ77UnComp invalid displacement");
+                return out;
+            }
+
+            if(displacement >= length) {
+                std::memcpy(out.ptr(cursor), out.ptr(cursor - displacement), length.get());
+                cursor += length;
+            } else {
+                // overlapping copies repeat the last displacement bytes
+                for(usize j = 0_usize; j < length; ++j, ++cursor) {
+                    out[cursor] = out[cursor - displacement];
+                }
+            }
+        }
+    }
+
+    return out;
+}
+
+vector<u8> arm7tdmi::hle_rl_uncomp() noexcept
+{
+    u32 src = r_[0_u32];
+    source_reader reader{bus_, src};
+    const usize size{reader.read_32(src) >> 8_u32};
+    src += 4_u32;
+
+    vector<u8> out{size};
+    usize cursor;
+    while(cursor < size) {
+        const u8 flag = reader.read_8(src++);
+        if(bit::test(flag, 7_u8)) {
+            const usize length = std::min(widen<usize>(flag & 0x7F_u8) + 3_usize, size - cursor);
+            std::fill_n(out.ptr(cursor), length.get(), reader.read_8(src++));
+            cursor += length;
+        } else {
+            const usize length = std::min(widen<usize>(flag & 0x7F_u8) + 1_usize, size - cursor);
+            for(usize i = 0_usize; i < length; ++i) {
+                out[cursor++] = reader.read_8(src++);
+            }
+        }
+    }
+
+    return out;
+}
+
+vector<u8> arm7tdmi::hle_huff_uncomp() noexcept
+{
+    const u32 src = mask::clear(r_[0_u32], 0b11_u32);
+    source_reader reader{bus_, src};
+    const u32 header = reader.read_32(src);
+
+    u32 bits = header & 0xF_u32;
+    if(bits != 4_u32 && bits != 8_u32) {
+        LOG_WARN(arm, "hle HuffUnComp invalid data size {}", bits);
+        bits = 8_u32;
+    }
+
+    const u32 tree_base = src + 5_u32;
+    u32 stream = tree_base + (widen<u32>(reader.read_8(src + 4_u32)) << 1_u32) + 1_u32;
+
+    // node layout: bits 0-5 offset to children, bit 6 right child is data, bit 7 left child is data
+    u32 node_addr = tree_base;
+    u8 node = reader.read_8(node_addr);
+
+    // output is written in words
+    const usize size{((header >> 8_u32) + 3_u32) & ~3_u32};
+    vector<u8> out{size};
+    usize cursor;
+    u32 block;
+    u32 bits_seen;
+    while(cursor < size) {
+        u32 bitstream = reader.read_32(stream);
+        stream += 4_u32;
+
+        for(u32 i = 0_u32; i < 32_u32 && cursor < size; ++i, bitstream <<= 1_u32) {
+            const u32 child = mask::clear(node_addr, 1_u32) + widen<u32>(node & 0x3F_u8) * 2_u32 + 2_u32;
+            const bool right = bit::test(bitstream, 31_u8);
+            const bool is_data = bit::test(node, right ? 6_u8 : 7_u8);
+
+            node_addr = right ? child + 1_u32 : child;
+            if(!is_data) {
+                node = reader.read_8(node_addr);
+                continue;
+            }
+
+            const u32 data = widen<u32>(reader.read_8(node_addr)) & ((1_u32 << bits) - 1_u32);
+            block |= data << bits_seen;
+            bits_seen += bits;
+
+            node_addr = tree_base;
+            node = reader.read_8(node_addr);
+
+            if(bits_seen == 32_u32) {
+                memcpy(out, cursor, block);
+                cursor += 4_usize;
+                block = 0_u32;
+                bits_seen = 0_u32;
+            }
+        }
+    }
+
+    return out;
+}
+
+template<typename T>
+void arm7tdmi::hle_write_uncompressed(const vector<u8>& data) noexcept
+{
+    const u32 dst = r_[1_u32];
+
+    // vram drops 8 bit writes, only ram takes the bulk path for them
+    const u32 dst_page = dst >> 24_u32;
+    const bool can_write_bytes = dst_page == 0x02_u32 || dst_page == 0x03_u32;
+
+    // trailing partial unit is written padded with zeroes
+    const usize size = (data.size() + (sizeof(T) - 1)) & ~usize{sizeof(T) - 1};
+    const u32 count = narrow<u32>(size / sizeof(T));
+    if(count == 0_u32) {
+        return;
+    }
+
+    if(u8* destination = bus_->writable_memory(dst, size); destination && (sizeof(T) != 1 || can_write_bytes)) {
+        std::memcpy(destination, data.data(), data.size().get());
+        std::fill(destination + data.size().get(), destination + size.get(), 0_u8);
+        if constexpr(std::is_same_v<T, u32>) {
+            bus_->tick_burst_32(dst, count);
+        } else {
+            bus_->tick_burst_16(dst, count);
+        }
+        return;
+    }
+
+    mem_access access = mem_access::non_seq;
+    for(usize offset; offset < size; offset += sizeof(T)) {
+        T unit;
+        for(usize i = 0_usize; i < sizeof(T) && offset + i < data.size(); ++i) {
+            unit |= widen<T>(data[offset + i]) << narrow<T>(8_usize * i);
+        }
+
+        const u32 addr = dst + narrow<u32>(offset);
+        if constexpr(std::is_same_v<T, u32>) {
+            bus_->write_32(addr, unit, access);
+        } else if constexpr(std::is_same_v<T, u16>) {
+            bus_->write_16(addr, unit, access);
+        } else {
+            bus_->write_8(addr, unit, access);
+        }
+        access = mem_access::seq;
+    }
+}
+
+} // namespace gba::cpu
@@ -42,8 +42,18 @@ void cpu::tick() noexcept
 
     if(LIKELY(haltcnt_ == halt_control::running)) {
         execute_instruction();
+
+        if(UNLIKELY(idle_loop_.detected)) {
+            // the loop will spin until the next event, behave like halted until then
+            idle_loop_.detected = false;
+
+            const u32 cycles = bus_->cycles_to_next_event();
+            idle_loop_stats_.skipped_cycles += cycles;
+            ++idle_loop_stats_.skip_count;
+            bus_->tick_components(cycles);
+        }
     } else {
-        bus_->tick_components(scheduler_->remaining_cycles_to_next_event());
+        bus_->tick_components(bus_->cycles_to_next_event());
     }
 }
 
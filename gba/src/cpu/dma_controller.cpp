@@ -8,6 +8,8 @@
 #include <gba/cpu/dma_controller.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 #include <gba/archive.h>
 #include <gba/cpu/bus_interface.h>
@@ -17,6 +19,9 @@ namespace gba::dma {
 
 namespace {
 
+constexpr u32 fifo_addr_a = 0x0400'00A0_u32;
+constexpr u32 fifo_addr_b = 0x0400'00A4_u32;
+
 constexpr array channel_masks{
   data{0x07FF'FFFF_u32, 0x07FF'FFFF_u32, 0x3FFF_u32},
   data{0x0FFF'FFFF_u32, 0x07FF'FFFF_u32, 0x3FFF_u32},
@@ -37,6 +42,14 @@ void sort_by_priority(static_vector<channel*, channel_count>& channels) noexcept
       (channel->id == 1_u32 || channel->id == 2_u32);
 }
 
+// sound events never look at memory, they are free to fire in the middle of a block transfer
+constexpr u32 sound_event_sources = 1_u32 << from_enum<u32>(scheduler::event_source::apu_sequencer)
+  | 1_u32 << from_enum<u32>(scheduler::event_source::apu_mixer)
+  | 1_u32 << from_enum<u32>(scheduler::event_source::apu_pulse1)
+  | 1_u32 << from_enum<u32>(scheduler::event_source::apu_pulse2)
+  | 1_u32 << from_enum<u32>(scheduler::event_source::apu_wave)
+  | 1_u32 << from_enum<u32>(scheduler::event_source::apu_noise);
+
 [[nodiscard]] FORCEINLINE bool addr_in_rom_area(const u32 addr) noexcept
 {
     const u32 page = addr >> 24_u32;
@@ -123,7 +136,7 @@ void channel::deserialize(const archive& archive) noexcept
 controller::controller(cpu::bus_interface* bus, cpu::irq_controller_handle irq, scheduler* scheduler) noexcept
   : bus_{bus}, irq_{irq}, scheduler_{scheduler}
 {
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT(controller::on_channel_start), "dma::start");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT(controller::on_channel_start), "dma::start");
 }
 
 void controller::write_cnt_l(const usize idx, const u8 data) noexcept
@@ -197,41 +210,54 @@ void controller::run_channels() noexcept
             dst_control = channel::control::address_control::fixed;
         }
 
-        switch(size) {
-            case channel::control::transfer_size::hword: {
-                if(LIKELY(channel->internal.src >= 0x0200'0000_u32)) {
-                    const u16 data = bus_->read_16(channel->internal.src, channel->next_access_type);
-                    channel->latch = (widen<u32>(data) << 16_u32) | data;
-                    latch_ = channel->latch;
-                } else {
-                    bus_->idle();
-                }
-
-                bus_->write_16(channel->internal.dst, narrow<u16>(channel->latch), channel->next_access_type);
+        // the first access is non sequential and goes through the bus like any other
+        u32 transferred;
+        if(for_fifo) {
+            transferred = transfer_fifo(*channel);
+        } else if(channel->next_access_type == cpu::mem_access::seq) {
+            transferred = size == channel::control::transfer_size::word
+              ? transfer_block<u32>(*channel)
+              : transfer_block<u16>(*channel);
+        }
 
-                static constexpr array modify_offsets{2_i32, -2_i32, 0_i32, 2_i32};
-                channel->internal.src += modify_offsets[from_enum<u32>(src_control)];
-                channel->internal.dst += modify_offsets[from_enum<u32>(dst_control)];
-                break;
-            }
-            case channel::control::transfer_size::word: {
-                if(LIKELY(channel->internal.src >= 0x0200'0000_u32)) {
-                    channel->latch = bus_->read_32(channel->internal.src, channel->next_access_type);
-                    latch_ = channel->latch;
-                } else {
-                    bus_->idle();
+        if(transferred == 0_u32) {
+            transferred = 1_u32;
+            switch(size) {
+                case channel::control::transfer_size::hword: {
+                    if(LIKELY(channel->internal.src >= 0x0200'0000_u32)) {
+                        const u16 data = bus_->read_16(channel->internal.src, channel->next_access_type);
+                        channel->latch = (widen<u32>(data) << 16_u32) | data;
+                        latch_ = channel->latch;
+                    } else {
+                        bus_->idle();
+                    }
+
+                    bus_->write_16(channel->internal.dst, narrow<u16>(channel->latch), channel->next_access_type);
+
+                    static constexpr array modify_offsets{2_i32, -2_i32, 0_i32, 2_i32};
+                    channel->internal.src += modify_offsets[from_enum<u32>(src_control)];
+                    channel->internal.dst += modify_offsets[from_enum<u32>(dst_control)];
+                    break;
+                }
+                case channel::control::transfer_size::word: {
+                    if(LIKELY(channel->internal.src >= 0x0200'0000_u32)) {
+                        channel->latch = bus_->read_32(channel->internal.src, channel->next_access_type);
+                        latch_ = channel->latch;
+                    } else {
+                        bus_->idle();
+                    }
+
+                    bus_->write_32(channel->internal.dst, channel->latch, channel->next_access_type);
+
+                    static constexpr array modify_offsets{4_i32, -4_i32, 0_i32, 4_i32};
+                    channel->internal.src += modify_offsets[from_enum<u32>(src_control)];
+                    channel->internal.dst += modify_offsets[from_enum<u32>(dst_control)];
+                    break;
                 }
-
-                bus_->write_32(channel->internal.dst, channel->latch, channel->next_access_type);
-
-                static constexpr array modify_offsets{4_i32, -4_i32, 0_i32, 4_i32};
-                channel->internal.src += modify_offsets[from_enum<u32>(src_control)];
-                channel->internal.dst += modify_offsets[from_enum<u32>(dst_control)];
-                break;
             }
         }
 
-        --channel->internal.count;
+        channel->internal.count -= transferred;
         channel->next_access_type = cpu::mem_access::seq;
 
         if(channel->internal.count == 0_u32) {
@@ -253,11 +279,156 @@ void controller::run_channels() noexcept
     is_running_ = false;
 }
 
-void controller::request(const occasion occasion) noexcept
+template<typename T>
+u32 controller::transfer_block(channel& channel) noexcept
+{
+    using address_control = channel::control::address_control;
+
+    const bool fill = channel.cnt.src_control == address_control::fixed;
+    if((!fill && channel.cnt.src_control != address_control::increment)
+      || (channel.cnt.dst_control != address_control::increment && channel.cnt.dst_control != address_control::inc_reload)
+      || channel.internal.src < 0x0200'0000_u32) {
+        return 0_u32;
+    }
+
+    constexpr u32 unit_size = narrow<u32>(usize{sizeof(T)});
+    const u32 src = channel.internal.src;
+    const u32 dst = channel.internal.dst;
+    u32 count = channel.internal.count;
+
+    // the block is all sequential accesses, rom forces a non sequential one on 128K boundaries
+    if(addr_in_rom_area(src)) {
+        const u32 boundary_offset = src & 0x1'FFFF_u32;
+        if(boundary_offset == 0_u32) {
+            return 0_u32;
+        }
+        if(!fill) {
+            count = std::min(count, (0x2'0000_u32 - boundary_offset) / unit_size);
+        }
+    }
+
+    u32 unit_cycles;
+    if constexpr(std::is_same_v<T, u32>) {
+        unit_cycles = bus_->access_cycles_32(src, cpu::mem_access::seq) + bus_->access_cycles_32(dst, cpu::mem_access::seq);
+    } else {
+        unit_cycles = bus_->access_cycles_16(src, cpu::mem_access::seq) + bus_->access_cycles_16(dst, cpu::mem_access::seq);
+    }
+
+    // stop before the unit that lets an event fire, it may start a higher priority channel or read the memory
+    const u64 cycle_budget = scheduler_->cycles_before_next_event(sound_event_sources);
+    if(cycle_budget == 0_u64) {
+        return 0_u32;
+    }
+    count = narrow<u32>(std::min(widen<u64>(count), (cycle_budget - 1_u64) / widen<u64>(unit_cycles)));
+
+    const view<u8> source = bus_->readable_memory(src);
+    if(!fill) {
+        count = std::min(count, narrow<u32>(source.size() / usize{unit_size}));
+    }
+    if(count == 0_u32 || source.size() < usize{unit_size}) {
+        return 0_u32;
+    }
+
+    const usize size{count * unit_size};
+    const usize read_size = fill ? usize{unit_size} : size;
+    u8* destination = bus_->writable_memory(dst, size);
+    if(!destination) {
+        return 0_u32;
+    }
+
+    // unit by unit transfers see their own writes, leave overlapping ones to the slow path
+    const auto source_begin = reinterpret_cast<std::uintptr_t>(source.data()); // NOLINT
+    const auto destination_begin = reinterpret_cast<std::uintptr_t>(destination); // NOLINT
+    if(source_begin < destination_begin + size.get() && destination_begin < source_begin + read_size.get()) {
+        return 0_u32;
+    }
+
+    const T last = memcpy<T>(source, read_size - usize{unit_size});
+    if(fill) {
+        for(usize offset; offset < size; offset += usize{unit_size}) {
+            std::memcpy(destination + offset.get(), &last, sizeof(T));
+        }
+    } else {
+        std::memcpy(destination, source.data(), size.get());
+    }
+
+    if constexpr(std::is_same_v<T, u32>) {
+        channel.latch = last;
+    } else {
+        channel.latch = (widen<u32>(last) << 16_u32) | last;
+    }
+    latch_ = channel.latch;
+
+    if(!fill) {
+        channel.internal.src += narrow<u32>(size);
+    }
+    channel.internal.dst += narrow<u32>(size);
+
+    // sound events reschedule relative to how late they are, never let them be late by more than their period
+    u32 cycles = count * unit_cycles;
+    while(cycles != 0_u32) {
+        const u32 step = narrow<u32>(std::clamp(scheduler_->cycles_before_next_event(), u64{1_u64}, widen<u64>(cycles)));
+        bus_->tick_components(step);
+        cycles -= step;
+    }
+    return count;
+}
+
+u32 controller::transfer_fifo(channel& channel) noexcept
 {
-    constexpr u32 fifo_addr_a = 0x0400'00A0_u32;
-    constexpr u32 fifo_addr_b = 0x0400'00A4_u32;
+    using address_control = channel::control::address_control;
+
+    constexpr u32 unit_count = 4_u32;
+    const u32 src = channel.internal.src;
+    const u32 dst = channel.internal.dst;
+    const bool fill = channel.cnt.src_control == address_control::fixed;
+    if(channel.internal.count != unit_count
+      || (!fill && channel.cnt.src_control != address_control::increment)
+      || (dst != fifo_addr_a && dst != fifo_addr_b)
+      || src < 0x0200'0000_u32) {
+        return 0_u32;
+    }
+
+    const view<u8> source = bus_->readable_memory(src);
+    if(source.size() < (fill ? 4_usize : 16_usize)) {
+        return 0_u32;
+    }
+
+    const auto src_of = [&](const u32 unit) { return fill ? src : src + unit * 4_u32; };
+    const auto access_of = [&](const u32 unit) { return unit == 0_u32 ? channel.next_access_type : cpu::mem_access::seq; };
+
+    u32 cycles = bus_->access_cycles_32(dst, channel.next_access_type) + 3_u32 * bus_->access_cycles_32(dst, cpu::mem_access::seq);
+    for(u32 unit = 0_u32; unit < unit_count; ++unit) {
+        cycles += bus_->access_cycles_32(src_of(unit), access_of(unit));
+    }
+
+    // a timer overflow in between would see a partially refilled fifo
+    if(widen<u64>(cycles) >= scheduler_->cycles_before_next_event(sound_event_sources)) {
+        return 0_u32;
+    }
+
+    array<u8, 16> samples;
+    for(u32 unit = 0_u32; unit < unit_count; ++unit) {
+        std::memcpy(samples.ptr(usize{unit * 4_u32}), source.ptr(fill ? 0_usize : usize{unit * 4_u32}), 4u);
+    }
+    bus_->write_sound_fifo(dst, view<u8>{samples});
 
+    channel.latch = memcpy<u32>(samples, 12_usize);
+    latch_ = channel.latch;
+    if(!fill) {
+        channel.internal.src += 16_u32;
+    }
+
+    // reads keep their rom prefetch side effects, the fifo is written to with a non sequential access and three sequential ones
+    for(u32 unit = 0_u32; unit < unit_count; ++unit) {
+        bus_->tick_fetch_32(src_of(unit), access_of(unit));
+    }
+    bus_->tick_burst_32(dst, unit_count);
+    return unit_count;
+}
+
+void controller::request(const occasion occasion) noexcept
+{
     switch(occasion) {
         case occasion::vblank:
             for(channel& channel : channels_) {
@@ -330,7 +501,9 @@ void controller::schedule(channel& channel, const channel::control::timing timin
 {
     if(channel.cnt.enabled && channel.cnt.when == timing && UNLIKELY(channel.cnt.src_control != channel::control::address_control::inc_reload)) {
         if(std::find(running_channels_.begin(), running_channels_.end(), &channel) == running_channels_.end()) {
-            channel.last_event_handle = scheduler_->add_hw_event(2_u32, MAKE_HW_EVENT(controller::on_channel_start));
+            channel.last_event_handle = scheduler_->add_hw_event(
+              to_enum<scheduler::event_source>(from_enum<u32>(scheduler::event_source::dma0) + channel.id),
+              2_u32, MAKE_HW_EVENT(controller::on_channel_start));
             scheduled_channels_.push_back(&channel);
         }
     }
@@ -21,14 +21,9 @@ constexpr u32 overflow_value = 0x1'0000_u32;
 
 u8 timer::read(const register_type reg) const noexcept
 {
-    u32 counter = counter_;
-    if(scheduler_->has_event(handle_)) {
-        counter += calculate_counter_delta();
-    }
-
     switch(reg) {
-        case register_type::cnt_l_lsb: return narrow<u8>(counter);
-        case register_type::cnt_l_msb: return narrow<u8>(counter >> 8_u32);
+        case register_type::cnt_l_lsb: return narrow<u8>(read_counter());
+        case register_type::cnt_l_msb: return narrow<u8>(read_counter() >> 8_u16);
         case register_type::cnt_h_lsb:
             return control_.prescalar
               | bit::from_bool<u8>(control_.cascaded) << 2_u8
@@ -39,6 +34,15 @@ u8 timer::read(const register_type reg) const noexcept
     }
 }
 
+u16 timer::read_counter() const noexcept
+{
+    u32 counter = counter_;
+    if(scheduler_->has_event(handle_)) {
+        counter += calculate_counter_delta();
+    }
+    return narrow<u16>(counter);
+}
+
 void timer::write(const register_type reg, const u8 data) noexcept
 {
     switch(reg) {
@@ -95,6 +99,7 @@ void timer::schedule_overflow(const u32 late_cycles) noexcept
 {
     last_scheduled_timestamp_ = scheduler_->now() - late_cycles;
     handle_ = scheduler_->add_hw_event(
+      to_enum<scheduler::event_source>(from_enum<u32>(scheduler::event_source::timer0) + id_),
       ((overflow_value - counter_) << prescalar_shifts[control_.prescalar]) - late_cycles,
       MAKE_HW_EVENT(timer::overflow));
 }
@@ -163,10 +168,10 @@ controller::controller(scheduler* scheduler, cpu::irq_controller_handle irq) noe
       timer{3_u32, scheduler, irq}
     }
 {
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(0_usize)), "timer0::overflow");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(1_usize)), "timer1::overflow");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(2_usize)), "timer2::overflow");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(3_usize)), "timer3::overflow");
+    scheduler->event_registry().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(0_usize)), "timer0::overflow");
+    scheduler->event_registry().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(1_usize)), "timer1::overflow");
+    scheduler->event_registry().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(2_usize)), "timer2::overflow");
+    scheduler->event_registry().register_entry(MAKE_HW_EVENT_V(timer::overflow, timers_.ptr(3_usize)), "timer3::overflow");
 
     for(u32 id : range(1_u32, 4_u32)) {
         timers_[id].cascade_instance = &timers_[id - 1_u32];
@@ -71,7 +71,7 @@ struct mmap::impl {
 
     u8* map_ptr = nullptr;
 
-    void map(const path& path, usize map_size, std::error_code& err) noexcept;
+    void map(const path& path, usize map_size, access mode, std::error_code& err) noexcept;
     void unmap(usize map_size, std::error_code& err) noexcept;
     void flush(usize flush_size, std::error_code& err) const noexcept;
     [[nodiscard]] bool is_mapped() const noexcept { return map_ptr != nullptr; }
@@ -103,6 +103,14 @@ mmap::mmap(path path, const usize map_size, std::error_code& err) noexcept
     map(map_size, err);
 }
 
+mmap::mmap(path path, const access mode, std::error_code& err) noexcept
+  : path_{std::move(path)},
+    access_{mode},
+    impl_{std::make_unique<impl>()}
+{
+    map(map_whole_file, err);
+}
+
 mmap::~mmap() noexcept
 {
     std::error_code err; // discarded
@@ -124,12 +132,14 @@ u8* mmap::ptr(const usize idx) noexcept
 mmap::mmap(mmap&& other) noexcept
   : path_{std::move(other.path_)},
     mapped_size_{std::exchange(other.mapped_size_, 0_usize)},
+    access_{other.access_},
     impl_{std::move(other.impl_)} {}
 
 mmap& mmap::operator=(mmap&& other) noexcept
 {
     path_ = std::move(other.path_);
     mapped_size_ = std::exchange(other.mapped_size_, 0_usize);
+    access_ = other.access_;
     impl_ = std::move(other.impl_);
     return *this;
 }
@@ -156,7 +166,7 @@ void mmap::map(const usize map_size, std::error_code& err) noexcept
         mapped_size_ = map_size;
     }
 
-    impl_->map(path_, mapped_size_, err);
+    impl_->map(path_, mapped_size_, access_, err);
 }
 
 void mmap::unmap(std::error_code& err) noexcept
@@ -182,16 +192,18 @@ bool mmap::is_mapped() const noexcept
     return false;
 }
 
-void mmap::impl::map(const path& path, usize map_size, std::error_code& err) noexcept
+void mmap::impl::map(const path& path, usize map_size, const access mode, std::error_code& err) noexcept
 {
     if(is_mapped()) {
         err = std::make_error_code(std::errc::already_connected);
         return;
     }
 
+    const bool read_only = mode == access::read_only;
+
 #ifdef _WIN32
     file_handle = CreateFileW(path.c_str(),
-      GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+      read_only ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
       OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
     if(file_handle == invalid_handle) {
         populate_err(err);
@@ -199,7 +211,7 @@ void mmap::impl::map(const path& path, usize map_size, std::error_code& err) noe
     }
 
     file_mapping_handle = CreateFileMappingW(file_handle,
-      nullptr, PAGE_READWRITE,
+      nullptr, read_only ? PAGE_READONLY : PAGE_READWRITE,
       map_size.get() >> 32, map_size.get(), nullptr);
     if(file_mapping_handle == invalid_handle) {
         populate_err(err);
@@ -207,21 +219,24 @@ void mmap::impl::map(const path& path, usize map_size, std::error_code& err) noe
     }
 
     map_ptr = static_cast<u8*>(MapViewOfFile(file_mapping_handle,
-      FILE_MAP_ALL_ACCESS, 0, 0, map_size.get()));
+      read_only ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS, 0, 0, map_size.get()));
     if(!map_ptr) {
         populate_err(err);
     }
 #else
-    file_handle = ::open(path.c_str(), O_RDWR);
+    file_handle = ::open(path.c_str(), read_only ? O_RDONLY : O_RDWR);
     if(file_handle == invalid_handle) {
         populate_err(err);
         return;
     }
 
     map_ptr = static_cast<u8*>(::mmap(nullptr, map_size.get(),
-      PROT_READ | PROT_WRITE, MAP_SHARED, file_handle, 0));
+      read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, file_handle, 0));
     if(map_ptr == MAP_FAILED) {
         populate_err(err);
+        map_ptr = nullptr;
+        ::close(file_handle);
+        file_handle = invalid_handle;
     }
 #endif // _WIN32
 }
@@ -7,6 +7,10 @@
 
 #include <gba/helper/gzip.h>
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
 #define ZLIB_CONST
 #include <zlib.h>
 
@@ -23,6 +27,91 @@ z_stream make_z_stream() noexcept
     return stream;
 }
 
+constexpr usize input_chunk_size = 64_kb;
+constexpr usize max_decompressed_size = usize{std::numeric_limits<u32::type>::max()};
+
+/*
+ * Inflates whatever read() supplies, one input chunk at a time. The trailer size is only
+ * a hint for the first allocation, the output grows as needed up to max_size. Members of
+ * a multi member gzip file are concatenated, zlib checks each member's crc and size.
+ */
+template<typename Reader>
+std::optional<vector<u8>> inflate_stream(Reader&& read, const usize size_hint, const usize max_size,
+  const chunk_callback& on_chunk) noexcept
+{
+    z_stream stream = make_z_stream();
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0u;
+
+    if(const int status = inflateInit2(&stream, 32 + MAX_WBITS); status != Z_OK) {
+        LOG_ERROR(fs, "gzip inflateInit2: {}", zError(status));
+        return std::nullopt;
+    }
+
+    const auto fail = [&]([[maybe_unused]] const char* error) {
+        LOG_ERROR(fs, "gzip inflate: {}", error);
+        inflateEnd(&stream);
+        return std::nullopt;
+    };
+
+    const auto refill = [&](vector<u8>& input) {
+        stream.next_in = reinterpret_cast<const Bytef*>(input.data()); // NOLINT
+        stream.avail_in = read(input.data(), input.size()).get();
+        return stream.avail_in != 0u;
+    };
+
+    vector<u8> input{input_chunk_size};
+    vector<u8> output{std::clamp(size_hint, 1_kb, std::max(max_size, 1_kb))};
+    usize produced;
+    while(true) {
+        if(stream.avail_in == 0u && !refill(input)) {
+            return fail("unexpected end of stream");
+        }
+
+        if(produced == output.size() && output.size() < max_size) {
+            output.resize(std::min(output.size() * 2_usize, max_size));
+        }
+
+        // at the limit the trailer may still be pending, only a byte past it is an overflow
+        u8 overflow;
+        const bool full = produced == output.size();
+        const usize available = full ? 1_usize : output.size() - produced;
+        stream.next_out = reinterpret_cast<Bytef*>(full ? &overflow : output.ptr(produced)); // NOLINT
+        stream.avail_out = available.get();
+
+        const int status = inflate(&stream, Z_NO_FLUSH);
+        if(status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            return fail(stream.msg != nullptr ? stream.msg : zError(status));
+        }
+
+        const usize inflated = available - stream.avail_out;
+        if(full && inflated != 0_usize) {
+            return fail("output exceeds the size limit");
+        }
+        if(on_chunk && inflated != 0_usize) {
+            on_chunk(view<u8>{output.ptr(produced), inflated});
+        }
+        produced += inflated;
+
+        if(status == Z_STREAM_END) {
+            if(stream.avail_in == 0u && !refill(input)) {
+                break;
+            }
+
+            // anything but another gzip member is padding
+            if(*stream.next_in != 0x1F) {
+                LOG_WARN(fs, "gzip inflate: ignoring trailing data after the last member");
+                break;
+            }
+            inflateReset(&stream);
+        }
+    }
+
+    inflateEnd(&stream);
+    output.resize(produced);
+    return output;
+}
+
 } // namespace
 
 std::optional<vector<u8>> compress(const vector<u8>& decompressed) noexcept
@@ -56,29 +145,43 @@ std::optional<vector<u8>> compress(const vector<u8>& decompressed) noexcept
 
 std::optional<vector<u8>> decompress(const vector<u8>& compressed) noexcept
 {
-    z_stream stream = make_z_stream();
-
-    if(const int status = inflateInit2(&stream, 32 + MAX_WBITS); status != Z_OK) {
-        LOG_ERROR(fs, "gzip inflateInit2: {}", zError(status));
-        return std::nullopt;
-    }
+    usize offset;
+    const auto read = [&](u8* buffer, const usize capacity) noexcept {
+        const usize size = std::min(capacity, compressed.size() - offset);
+        std::copy_n(compressed.ptr(offset), size.get(), buffer);
+        offset += size;
+        return size;
+    };
 
     // last 4 bytes encodes size modulo 2^32 (modulo can be ignored)
-    const u32 decompressed_size = memcpy<u32>(compressed, compressed.size() - 4_usize);
-
-    vector<u8> decompressed{decompressed_size};
-    stream.next_in = reinterpret_cast<const Bytef*>(compressed.data()); // NOLINT
-    stream.avail_in = compressed.size().get();
-    stream.next_out = reinterpret_cast<Bytef*>(decompressed.data()); // NOLINT
-    stream.avail_out = decompressed.size().get();
+    const usize size_hint = compressed.size() < 4_usize
+      ? 0_usize
+      : usize{memcpy<u32>(compressed, compressed.size() - 4_usize)};
+    return inflate_stream(read, size_hint, max_decompressed_size, chunk_callback{});
+}
 
-    if(const int status = inflate(&stream, Z_FINISH); status < Z_OK) {
-        LOG_ERROR(fs, "gzip inflate: {}", zError(status));
+std::optional<vector<u8>> decompress_file(const fs::path& path, const usize max_size, const chunk_callback& on_chunk) noexcept
+{
+    std::ifstream stream{path, std::ios::binary | std::ios::ate};
+    if(!stream.is_open()) {
+        LOG_ERROR(fs, "input file stream could not be opened: {}", path.string());
         return std::nullopt;
     }
 
-    inflateEnd(&stream);
-    return decompressed;
+    usize size_hint;
+    if(const std::ifstream::pos_type file_size = stream.tellg(); file_size >= 4) {
+        u32 isize;
+        stream.seekg(-4, std::ios::end);
+        stream.read(reinterpret_cast<char*>(&isize), sizeof(isize)); // NOLINT
+        size_hint = std::min(usize{isize}, max_size);
+    }
+    stream.seekg(0, std::ios::beg);
+
+    const auto read = [&](u8* buffer, const usize capacity) noexcept {
+        stream.read(reinterpret_cast<char*>(buffer), capacity.get()); // NOLINT
+        return usize{static_cast<usize::type>(stream.gcount())};
+    };
+    return inflate_stream(read, size_hint, max_size, on_chunk);
 }
 
 } // namespace gba::gzip
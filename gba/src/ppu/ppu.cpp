@@ -12,6 +12,7 @@
 #include <gba/archive.h>
 #include <gba/core/scheduler.h>
 #include <gba/helper/range.h>
+#include <gba/ppu/ppu_worker.h>
 
 namespace gba::ppu {
 
@@ -30,10 +31,28 @@ constexpr u8 video_dma_end_line = 162_u8;
 engine::engine(scheduler* scheduler) noexcept
   : scheduler_{scheduler}
 {
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT(ppu::engine::on_hblank), "ppu::hblank");
-    hw_event_registry::get().register_entry(MAKE_HW_EVENT(ppu::engine::on_hdraw), "ppu::hdraw");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT(ppu::engine::on_hblank), "ppu::hblank");
+    scheduler_->event_registry().register_entry(MAKE_HW_EVENT(ppu::engine::on_hdraw), "ppu::hdraw");
 
-    scheduler_->add_hw_event(cycles_hdraw, MAKE_HW_EVENT(ppu::engine::on_hblank));
+    scheduler_->add_hw_event(scheduler::event_source::ppu, cycles_hdraw, MAKE_HW_EVENT(ppu::engine::on_hblank));
+}
+
+engine::~engine() = default;
+
+void engine::set_threaded_rendering(const bool enabled)
+{
+    if(enabled == threaded_rendering()) {
+        return;
+    }
+
+    if(enabled) {
+        // the worker starts with an empty copy of video memory
+        std::fill(dirty_blocks_.begin(), dirty_blocks_.end(), true);
+        worker_ = std::make_unique<scanline_worker>();
+    } else {
+        flush_rendered_lines();
+        worker_.reset();
+    }
 }
 
 void engine::check_vcounter_irq() noexcept
@@ -49,12 +68,15 @@ void engine::check_vcounter_irq() noexcept
 
 void engine::on_hdraw(const u32 late_cycles) noexcept
 {
-    scheduler_->add_hw_event(cycles_hdraw - late_cycles, MAKE_HW_EVENT(ppu::engine::on_hblank));
+    scheduler_->add_hw_event(scheduler::event_source::ppu, cycles_hdraw - late_cycles, MAKE_HW_EVENT(ppu::engine::on_hblank));
     dispstat_.hblank = false;
 
     vcount_ = (vcount_ + 1_u8) % total_lines;
     if(vcount_ == screen_height) {
         dispstat_.vblank = true;
+        if(worker_) {
+            flush_rendered_lines();
+        }
         event_on_vblank();
 
         dma_.request_dma(dma::occasion::vblank);
@@ -79,13 +101,18 @@ void engine::on_hdraw(const u32 late_cycles) noexcept
 
 void engine::on_hblank(const u32 late_cycles) noexcept
 {
-    scheduler_->add_hw_event(cycles_hblank - late_cycles, MAKE_HW_EVENT(ppu::engine::on_hdraw));
+    scheduler_->add_hw_event(scheduler::event_source::ppu, cycles_hblank - late_cycles, MAKE_HW_EVENT(ppu::engine::on_hdraw));
     dispstat_.hblank = true;
 
     if(dispstat_.hblank_irq_enabled) {
         irq_.request_interrupt(cpu::interrupt_source::hblank);
     }
 
+    // the worker generates its own window buffer from the flags as they are before this line
+    if(worker_ && vcount_ < screen_height) {
+        worker_->submit(*this);
+    }
+
     const bool any_window_enabled = dispcnt_.win0_enabled || dispcnt_.win1_enabled || dispcnt_.win_obj_enabled;
     if(any_window_enabled) {
         generate_window_buffer();
@@ -93,7 +120,9 @@ void engine::on_hblank(const u32 late_cycles) noexcept
 
     if(vcount_ < screen_height) {
         dma_.request_dma(dma::occasion::hblank);
-        render_scanline();
+        if(!worker_) {
+            render_scanline();
+        }
 
         mosaic_bg_.update_internal_v();
         mosaic_obj_.update_internal_v();
@@ -194,6 +223,84 @@ void engine::render_scanline() noexcept
     event_on_scanline(vcount_, final_buffer_);
 }
 
+u8* engine::dirty_block_data(const usize block) noexcept
+{
+    const usize offset = block * dirty_block_size;
+    if(offset < 96_kb) {
+        return vram_.ptr(offset);
+    }
+    return offset == 96_kb ? palette_ram_.data() : oam_.data();
+}
+
+void engine::on_block_write(const usize block) noexcept
+{
+    const usize offset = block * dirty_block_size;
+    if(offset < 96_kb) {
+        on_vram_write(offset, dirty_block_size);
+    } else if(offset == 96_kb) {
+        on_palette_write(0_usize, dirty_block_size);
+    } else {
+        on_oam_write(0_usize, dirty_block_size);
+    }
+}
+
+void engine::invalidate_video_memory() noexcept
+{
+    on_vram_write(0_usize, 96_kb);
+    on_palette_write(0_usize, 1_kb);
+    on_oam_write(0_usize, 1_kb);
+}
+
+line_registers engine::save_line_registers() const noexcept
+{
+    line_registers registers;
+    registers.dispcnt = dispcnt_;
+    registers.vcount = vcount_;
+    registers.bg0 = bg0_;
+    registers.bg1 = bg1_;
+    registers.bg2 = bg2_;
+    registers.bg3 = bg3_;
+    registers.win0 = win0_;
+    registers.win1 = win1_;
+    registers.win_in = win_in_;
+    registers.win_out = win_out_;
+    registers.win_can_draw_flags = win_can_draw_flags_;
+    registers.green_swap = green_swap_;
+    registers.mosaic_bg = mosaic_bg_;
+    registers.mosaic_obj = mosaic_obj_;
+    registers.bldcnt = bldcnt_;
+    registers.blend_settings = blend_settings_;
+    return registers;
+}
+
+void engine::load_line_registers(const line_registers& registers) noexcept
+{
+    dispcnt_ = registers.dispcnt;
+    vcount_ = registers.vcount;
+    bg0_ = registers.bg0;
+    bg1_ = registers.bg1;
+    bg2_ = registers.bg2;
+    bg3_ = registers.bg3;
+    win0_ = registers.win0;
+    win1_ = registers.win1;
+    win_in_ = registers.win_in;
+    win_out_ = registers.win_out;
+    win_can_draw_flags_ = registers.win_can_draw_flags;
+    green_swap_ = registers.green_swap;
+    mosaic_bg_ = registers.mosaic_bg;
+    mosaic_obj_ = registers.mosaic_obj;
+    bldcnt_ = registers.bldcnt;
+    blend_settings_ = registers.blend_settings;
+}
+
+void engine::flush_rendered_lines() noexcept
+{
+    worker_->wait_idle();
+    worker_->take_rendered_lines([&](const u8 line, const scanline_buffer& buffer) {
+        event_on_scanline(line, buffer);
+    });
+}
+
 void engine::serialize(archive& archive) const noexcept
 {
     archive.serialize(palette_ram_);
@@ -282,9 +389,13 @@ void engine::serialize(archive& archive) const noexcept
 
 void engine::deserialize(const archive& archive) noexcept
 {
+    if(worker_) {
+        flush_rendered_lines();
+    }
     archive.deserialize(palette_ram_);
     archive.deserialize(vram_);
     archive.deserialize(oam_);
+    invalidate_video_memory();
 
     dispcnt_.write_lower(archive.deserialize<u8>());
     dispcnt_.write_upper(archive.deserialize<u8>());
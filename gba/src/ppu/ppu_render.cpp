@@ -9,6 +9,16 @@
 
 #include <algorithm>
 
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define HAS_SIMD_COMPOSITOR 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define HAS_SIMD_COMPOSITOR 1
+#else
+  #define HAS_SIMD_COMPOSITOR 0
+#endif
+
 #include <gba/core/algorithm.h>
 
 namespace gba::ppu {
@@ -18,23 +28,194 @@ namespace {
 struct layer {
     enum class type { bg0, bg1, bg2, bg3, obj, bd };
 
-    static inline u32 invalid_priority = 4_u32;
+    static constexpr u32 invalid_priority = 4_u32;
 
     type layer_type{type::bd};
     u32 priority = invalid_priority;
 };
 
+#if HAS_SIMD_COMPOSITOR
+
+// 16 bit lanes, one dot each
+namespace simd {
+
+#if defined(__AVX2__)
+using reg = __m256i;
+
+FORCEINLINE reg load(const void* src) noexcept { return _mm256_loadu_si256(static_cast<const reg*>(src)); }
+FORCEINLINE void store(void* dst, const reg r) noexcept { _mm256_storeu_si256(static_cast<reg*>(dst), r); }
+FORCEINLINE reg set(const u16 value) noexcept { return _mm256_set1_epi16(static_cast<short>(value.get())); }
+FORCEINLINE reg bit_and(const reg a, const reg b) noexcept { return _mm256_and_si256(a, b); }
+FORCEINLINE reg bit_or(const reg a, const reg b) noexcept { return _mm256_or_si256(a, b); }
+FORCEINLINE reg and_not(const reg a, const reg b) noexcept { return _mm256_andnot_si256(b, a); }
+FORCEINLINE reg equal(const reg a, const reg b) noexcept { return _mm256_cmpeq_epi16(a, b); }
+FORCEINLINE reg greater(const reg a, const reg b) noexcept { return _mm256_cmpgt_epi16(a, b); }
+FORCEINLINE reg add(const reg a, const reg b) noexcept { return _mm256_add_epi16(a, b); }
+FORCEINLINE reg sub(const reg a, const reg b) noexcept { return _mm256_sub_epi16(a, b); }
+FORCEINLINE reg mul(const reg a, const reg b) noexcept { return _mm256_mullo_epi16(a, b); }
+FORCEINLINE reg min(const reg a, const reg b) noexcept { return _mm256_min_epi16(a, b); }
+template<int N> FORCEINLINE reg shift_right(const reg a) noexcept { return _mm256_srli_epi16(a, N); }
+template<int N> FORCEINLINE reg shift_left(const reg a) noexcept { return _mm256_slli_epi16(a, N); }
+#else
+using reg = __m128i;
+
+FORCEINLINE reg load(const void* src) noexcept { return _mm_loadu_si128(static_cast<const reg*>(src)); }
+FORCEINLINE void store(void* dst, const reg r) noexcept { _mm_storeu_si128(static_cast<reg*>(dst), r); }
+FORCEINLINE reg set(const u16 value) noexcept { return _mm_set1_epi16(static_cast<short>(value.get())); }
+FORCEINLINE reg bit_and(const reg a, const reg b) noexcept { return _mm_and_si128(a, b); }
+FORCEINLINE reg bit_or(const reg a, const reg b) noexcept { return _mm_or_si128(a, b); }
+FORCEINLINE reg and_not(const reg a, const reg b) noexcept { return _mm_andnot_si128(b, a); }
+FORCEINLINE reg equal(const reg a, const reg b) noexcept { return _mm_cmpeq_epi16(a, b); }
+FORCEINLINE reg greater(const reg a, const reg b) noexcept { return _mm_cmpgt_epi16(a, b); }
+FORCEINLINE reg add(const reg a, const reg b) noexcept { return _mm_add_epi16(a, b); }
+FORCEINLINE reg sub(const reg a, const reg b) noexcept { return _mm_sub_epi16(a, b); }
+FORCEINLINE reg mul(const reg a, const reg b) noexcept { return _mm_mullo_epi16(a, b); }
+FORCEINLINE reg min(const reg a, const reg b) noexcept { return _mm_min_epi16(a, b); }
+template<int N> FORCEINLINE reg shift_right(const reg a) noexcept { return _mm_srli_epi16(a, N); }
+template<int N> FORCEINLINE reg shift_left(const reg a) noexcept { return _mm_slli_epi16(a, N); }
+#endif
+
+constexpr u32::type lane_count = sizeof(reg) / sizeof(u16);
+static_assert(screen_width % lane_count == 0_u32);
+static_assert(sizeof(color) == sizeof(u16));
+
+// picks a where mask is set, b elsewhere
+FORCEINLINE reg select(const reg mask, const reg a, const reg b) noexcept { return bit_or(bit_and(mask, a), and_not(b, mask)); }
+FORCEINLINE reg none_set(const reg a, const reg bits) noexcept { return equal(bit_and(a, bits), set(0_u16)); }
+
+struct channels {
+    reg r;
+    reg g;
+    reg b;
+};
+
+FORCEINLINE channels unpack(const reg dots) noexcept
+{
+    const reg channel_mask = set(color::r_mask);
+    return channels{
+      bit_and(dots, channel_mask),
+      bit_and(shift_right<5>(dots), channel_mask),
+      bit_and(shift_right<10>(dots), channel_mask)
+    };
+}
+
+FORCEINLINE reg pack(const channels& c) noexcept
+{
+    return bit_or(c.r, bit_or(shift_left<5>(c.g), shift_left<10>(c.b)));
+}
+
+FORCEINLINE reg alpha_blend(const reg first, const reg second, const reg eva, const reg evb) noexcept
+{
+    const reg max_intensity = set(0x1F_u16);
+    const auto blend_channel = [&](const reg a, const reg b) {
+        return min(max_intensity, shift_right<4>(add(mul(a, eva), mul(b, evb))));
+    };
+
+    const channels a = unpack(first);
+    const channels b = unpack(second);
+    return pack(channels{blend_channel(a.r, b.r), blend_channel(a.g, b.g), blend_channel(a.b, b.b)});
+}
+
+FORCEINLINE reg brighten(const reg dots, const reg evy) noexcept
+{
+    const reg max_intensity = set(0x1F_u16);
+    const auto brighten_channel = [&](const reg c) {
+        return add(c, shift_right<4>(mul(sub(max_intensity, c), evy)));
+    };
+
+    const channels c = unpack(dots);
+    return pack(channels{brighten_channel(c.r), brighten_channel(c.g), brighten_channel(c.b)});
+}
+
+FORCEINLINE reg darken(const reg dots, const reg evy) noexcept
+{
+    const auto darken_channel = [&](const reg c) {
+        return sub(c, shift_right<4>(mul(c, evy)));
+    };
+
+    const channels c = unpack(dots);
+    return pack(channels{darken_channel(c.r), darken_channel(c.g), darken_channel(c.b)});
+}
+
+} // namespace simd
+
+#endif // HAS_SIMD_COMPOSITOR
+
 } // namespace
 
+void engine::update_obj_lines() noexcept
+{
+    const view<obj> objs{oam_};
+    for(usize idx : range(obj_count)) {
+        if(obj_lines_valid_[idx]) {
+            continue;
+        }
+
+        const u32 word = narrow<u32>(idx / 64_usize);
+        const u64 obj_bit = 1_u64 << narrow<u32>(idx % 64_usize);
+
+        obj_lines& lines = obj_lines_[idx];
+        for(u32 line : range<u32>(lines.first_line, lines.end_line)) {
+            line_objs_[line][word] &= ~obj_bit;
+        }
+
+        lines = obj_lines{};
+        obj_lines_valid_[idx] = true;
+
+        const obj& obj = objs[idx];
+        const obj_attr0::rendering_mode render_mode = obj.attr0.render_mode();
+        const u32 shape_idx = obj.attr0.shape_idx();
+        if(render_mode == obj_attr0::rendering_mode::hidden || obj.attr0.blending() == obj_attr0::blend_mode::prohibited
+          || shape_idx >= obj::dimensions.size()) {
+            continue;
+        }
+
+        lines.is_affine = render_mode == obj_attr0::rendering_mode::affine
+          || render_mode == obj_attr0::rendering_mode::affine_double;
+        lines.dimensions = obj::dimensions[shape_idx][obj.attr1.size_idx()];
+        lines.half_dimensions = render_mode == obj_attr0::rendering_mode::affine_double
+          ? lines.dimensions
+          : dimension<u8>{lines.dimensions.h / 2_u8, lines.dimensions.v / 2_u8};
+
+        i32 y = obj.attr0.y();
+        i32 x = obj.attr1.x();
+
+        if(y >= make_signed(screen_height)) { y -= 256_i32; }
+        if(x >= make_signed(screen_width)) { x -= 512_i32; }
+
+        lines.y = y + lines.half_dimensions.v;
+        lines.x = x + lines.half_dimensions.h;
+
+        const i32 top = std::max(i32{0_i32}, y);
+        const i32 bottom = std::min(make_signed(screen_height), lines.y + lines.half_dimensions.v);
+        if(top >= bottom) {
+            continue;
+        }
+
+        lines.first_line = narrow<u8>(make_unsigned(top));
+        lines.end_line = narrow<u8>(make_unsigned(bottom));
+        for(u32 line : range<u32>(lines.first_line, lines.end_line)) {
+            line_objs_[line][word] |= obj_bit;
+        }
+    }
+
+    all_obj_lines_valid_ = true;
+}
+
 void engine::render_obj() noexcept
 {
     if(!dispcnt_.obj_enabled) {
         return;
     }
 
+    if(!all_obj_lines_valid_) {
+        update_obj_lines();
+    }
+
     static constexpr range<u8> bitmap_modes{3_u8, 6_u8};
     const bool in_bitmap_mode = bitmap_modes.contains(dispcnt_.bg_mode);
 
+    const view<obj> objs{oam_};
     const view<obj_affine> affine_view{oam_};
     i32 render_cycles_remaining = dispcnt_.hblank_interval_free
       ? 954_i32
@@ -42,36 +223,28 @@ void engine::render_obj() noexcept
 
     std::fill(obj_buffer_.begin(), obj_buffer_.end(), obj_buffer_entry{});
 
-    for(const obj& obj : view<obj>{oam_}) {
-        const obj_attr0::rendering_mode render_mode = obj.attr0.render_mode();
-        const obj_attr0::blend_mode blend_mode = obj.attr0.blending();
-        const u32 shape_idx = obj.attr0.shape_idx();
-
-        if(render_mode == obj_attr0::rendering_mode::hidden || blend_mode == obj_attr0::blend_mode::prohibited) {
-            continue;
+    static_vector<u8, obj_count.get()> line_objs;
+    for(u32 word : range(2_u32)) {
+        for(u64 bits = line_objs_[vcount_][word]; bits != 0_u64; bits &= bits - 1_u64) {
+            line_objs.push_back(narrow<u8>(word * 64_u32 + bit::lowest_set(bits)));
         }
+    }
 
-        const bool is_affine = render_mode == obj_attr0::rendering_mode::affine
-          || render_mode == obj_attr0::rendering_mode::affine_double;
-
-        const dimension<u8> dimensions = obj::dimensions[shape_idx][obj.attr1.size_idx()];
-        dimension<u8> half_dimensions{dimensions.h / 2_u8, dimensions.v / 2_u8};
-
-        i32 y = obj.attr0.y();
-        i32 x = obj.attr1.x();
-
-        if(y >= make_signed(screen_height)) { y -= 256_i32; }
-        if(x >= make_signed(screen_width)) { x -= 512_i32; }
+    for(const u8 idx : line_objs) {
+        const obj& obj = objs[idx];
+        const obj_lines& lines = obj_lines_[idx];
+        const obj_attr0::blend_mode blend_mode = obj.attr0.blending();
+        const bool is_affine = lines.is_affine;
+        const dimension<u8> dimensions = lines.dimensions;
+        const dimension<u8> half_dimensions = lines.half_dimensions;
+        const i32 x = lines.x;
+        const i32 y = lines.y;
 
         dimension<u32> flip_offsets{0_u32, 0_u32};
         obj_affine affine_matrix;
 
         if(is_affine) {
             affine_matrix = affine_view[obj.attr1.affine_idx()];
-
-            if(render_mode == obj_attr0::rendering_mode::affine_double) {
-                half_dimensions = dimensions;
-            }
         } else {
             static constexpr i16 p_flip = 0xFF00_i16;
             if(obj.attr1.h_flipped()) {
@@ -85,13 +258,6 @@ void engine::render_obj() noexcept
             }
         }
 
-        y += half_dimensions.v;
-        x += half_dimensions.h;
-
-        if(!range(y - half_dimensions.v, y + half_dimensions.v).contains(vcount_)) {
-            continue;
-        }
-
         i32 local_y = make_signed(widen<u32>(vcount_)) - y;
         mosaic_obj_.internal.h = 0_u8;
 
@@ -179,8 +345,149 @@ void engine::render_obj() noexcept
 }
 
 void engine::compose_impl(static_vector<bg_priority_pair, 4> ids) noexcept
+{
+    // stable sort bg ids to render them in least importance order
+    algo::insertion_sort(ids);
+    std::reverse(ids.begin(), ids.end());
+
+#if HAS_SIMD_COMPOSITOR
+    compose_simd(ids);
+#else
+    compose_scalar(ids);
+#endif // HAS_SIMD_COMPOSITOR
+
+    if(UNLIKELY(green_swap_)) {
+        for(u32 x = 0_u32; x < screen_width; x += 2_u32) {
+            final_buffer_[x].swap_green(final_buffer_[x + 1_u32]);
+        }
+    }
+}
+
+void engine::compose_simd(const static_vector<bg_priority_pair, 4>& ids) noexcept
+{
+#if HAS_SIMD_COMPOSITOR
+    const color backdrop = backdrop_color();
+    const bool any_window_enabled = dispcnt_.win0_enabled || dispcnt_.win1_enabled || dispcnt_.win_obj_enabled;
+
+    // layers are one bit each, in the same order as window enable and blend target bits
+    constexpr u16 obj_bit = 0x10_u16;
+    constexpr u16 backdrop_bit = 0x20_u16;
+    constexpr u16 blend_enable_bit = 0x20_u16;
+
+    // window and obj dots as flat lanes
+    array<u16, screen_width> win_masks;
+    array<u16, screen_width> obj_dots;
+    array<u16, screen_width> obj_priorities;
+    array<u16, screen_width> obj_alpha_masks;
+
+    if(any_window_enabled) {
+        const win_enable_bits* last_bits = nullptr;
+        u16 mask;
+        for(u32 x : range(screen_width)) {
+            if(win_buffer_[x] != last_bits) {
+                last_bits = win_buffer_[x];
+                mask = widen<u16>(last_bits->read());
+            }
+            win_masks[x] = mask;
+        }
+    }
+
+    if(dispcnt_.obj_enabled) {
+        for(u32 x : range(screen_width)) {
+            const obj_buffer_entry& entry = obj_buffer_[x];
+            obj_dots[x] = entry.dot.val;
+            obj_priorities[x] = narrow<u16>(entry.priority);
+            obj_alpha_masks[x] = entry.is_alpha_blending ? 0xFFFF_u16 : 0x0000_u16;
+        }
+    }
+
+    const simd::reg transparent = simd::set(color::transparent().val);
+    const simd::reg first_targets = simd::set(widen<u16>(bldcnt_.first.read()));
+    const simd::reg second_targets = simd::set(widen<u16>(bldcnt_.second.read()));
+    constexpr u8 max_ev = 0x10_u8;
+    const simd::reg eva = simd::set(widen<u16>(std::min(max_ev, blend_settings_.eva)));
+    const simd::reg evb = simd::set(widen<u16>(std::min(max_ev, blend_settings_.evb)));
+    const simd::reg evy = simd::set(widen<u16>(std::min(max_ev, blend_settings_.evy)));
+
+    for(u32 x = 0_u32; x < screen_width; x += simd::lane_count) {
+        const simd::reg win = any_window_enabled ? simd::load(win_masks.ptr(x)) : simd::set(0x3F_u16);
+
+        simd::reg top = simd::set(backdrop.val);
+        simd::reg top_layer = simd::set(backdrop_bit);
+        simd::reg top_priority = simd::set(narrow<u16>(layer::invalid_priority));
+        simd::reg bottom = top;
+        simd::reg bottom_layer = top_layer;
+        simd::reg bottom_priority = top_priority;
+
+        for(const auto& [priority, bg_id] : ids) {
+            const simd::reg bg_dots = simd::load(bg_buffers_[bg_id].ptr(x));
+            const simd::reg bg_bit = simd::set(narrow<u16>(1_u32 << bg_id));
+            const simd::reg hidden = simd::bit_or(simd::none_set(win, bg_bit), simd::equal(bg_dots, transparent));
+
+            bottom = simd::select(hidden, bottom, top);
+            bottom_layer = simd::select(hidden, bottom_layer, top_layer);
+            bottom_priority = simd::select(hidden, bottom_priority, top_priority);
+            top = simd::select(hidden, top, bg_dots);
+            top_layer = simd::select(hidden, top_layer, bg_bit);
+            top_priority = simd::select(hidden, top_priority, simd::set(narrow<u16>(priority)));
+        }
+
+        simd::reg has_alpha_obj_dot = simd::set(0_u16);
+        if(dispcnt_.obj_enabled) {
+            const simd::reg dots = simd::load(obj_dots.ptr(x));
+            const simd::reg priorities = simd::load(obj_priorities.ptr(x));
+            const simd::reg hidden = simd::bit_or(simd::none_set(win, simd::set(obj_bit)), simd::equal(dots, transparent));
+            const simd::reg below_top = simd::bit_or(hidden, simd::greater(priorities, top_priority));
+            const simd::reg below_bottom = simd::bit_or(hidden, simd::greater(priorities, bottom_priority));
+
+            bottom = simd::select(below_top, simd::select(below_bottom, bottom, dots), top);
+            bottom_layer = simd::select(below_top, simd::select(below_bottom, bottom_layer, simd::set(obj_bit)), top_layer);
+            top = simd::select(below_top, top, dots);
+            top_layer = simd::select(below_top, top_layer, simd::set(obj_bit));
+            has_alpha_obj_dot = simd::and_not(simd::load(obj_alpha_masks.ptr(x)), below_top);
+        }
+
+        const simd::reg no_dst = simd::none_set(top_layer, first_targets);
+        const simd::reg no_src = simd::none_set(bottom_layer, second_targets);
+        const simd::reg no_window_blend = any_window_enabled
+          ? simd::and_not(simd::none_set(win, simd::set(blend_enable_bit)), has_alpha_obj_dot)
+          : simd::set(0_u16);
+
+        simd::reg out = top;
+        switch(bldcnt_.type) {
+            case bldcnt::effect::none:
+                break;
+            case bldcnt::effect::alpha_blend:
+                out = simd::select(simd::bit_or(no_dst, simd::bit_or(no_window_blend, no_src)),
+                  top, simd::alpha_blend(top, bottom, eva, evb));
+                break;
+            case bldcnt::effect::brightness_inc:
+                out = simd::select(simd::bit_or(no_dst, no_window_blend), top, simd::brighten(top, evy));
+                break;
+            case bldcnt::effect::brightness_dec:
+                out = simd::select(simd::bit_or(no_dst, no_window_blend), top, simd::darken(top, evy));
+                break;
+            default:
+                UNREACHABLE();
+        }
+
+        // semi transparent objs alpha blend regardless of the effect
+        if(dispcnt_.obj_enabled) {
+            const simd::reg obj_alpha = simd::and_not(has_alpha_obj_dot, no_src);
+            out = simd::select(obj_alpha, simd::alpha_blend(top, bottom, eva, evb), out);
+        }
+
+        simd::store(final_buffer_.ptr(x), out);
+    }
+#else
+    compose_scalar(ids);
+#endif // HAS_SIMD_COMPOSITOR
+}
+
+void engine::compose_scalar(const static_vector<bg_priority_pair, 4>& ids) noexcept
 {
     const color backdrop = backdrop_color();
+    const bool any_window_enabled = dispcnt_.win0_enabled || dispcnt_.win1_enabled || dispcnt_.win_obj_enabled;
 
     const auto dot_for_layer = [&](const layer& l, u32 x) {
         switch(l.layer_type) {
@@ -208,12 +515,6 @@ void engine::compose_impl(static_vector<bg_priority_pair, 4> ids) noexcept
         }
     };
 
-    // stable sort bg ids to render them in least importance order
-    algo::insertion_sort(ids);
-    std::reverse(ids.begin(), ids.end());
-
-    const bool any_window_enabled = dispcnt_.win0_enabled || dispcnt_.win1_enabled || dispcnt_.win_obj_enabled;
-
     for(u32 x : range(screen_width)) {
         layer top_layer;
         layer bottom_layer;
@@ -255,32 +556,57 @@ void engine::compose_impl(static_vector<bg_priority_pair, 4> ids) noexcept
 
         final_buffer_[x] = top_dot;
     }
-
-    if(UNLIKELY(green_swap_)) {
-        for(u32 x = 0_u32; x < screen_width; x += 2_u32) {
-            final_buffer_[x].swap_green(final_buffer_[x + 1_u32]);
-        }
-    }
 }
 
-void engine::tile_line_8bpp(tile_line& out_line, const u32 y, const usize base_addr, const bg_map_entry entry) const noexcept
+void engine::tile_line_8bpp(tile_line& out_line, const u32 y, const usize base_addr, const bg_map_entry entry) noexcept
 {
     constexpr u32 total_tile_size = tile_dot_count * tile_dot_count;
-    for(u32 x : range(tile_dot_count)) {
-        const u8 color_idx = memcpy<u8>(vram_, base_addr + entry.tile_idx() * total_tile_size + y * tile_dot_count + x);
-        out_line[x] = palette_color(color_idx, 0_u8);
+    const usize row_addr = base_addr + entry.tile_idx() * total_tile_size + y * tile_dot_count;
+
+    const auto decode = [&](tile_line& line) {
+        for(u32 x : range(tile_dot_count)) {
+            line[x] = palette_color(memcpy<u8>(vram_, row_addr + x), 0_u8);
+        }
+    };
+
+    // tiles past vram are not cached
+    if(UNLIKELY(row_addr >= vram_.size())) {
+        decode(out_line);
+        return;
+    }
+
+    decoded_tile_line& decoded = decoded_lines_8bpp_[row_addr / tile_dot_count];
+    const u32 vram_generation = vram_generations_[row_addr / dirty_block_size];
+    const u32 palette_generation = palette_generations_[palette_bank_count];
+    if(decoded.vram_generation != vram_generation || decoded.palette_generation != palette_generation) {
+        decode(decoded.dots);
+        decoded.vram_generation = vram_generation;
+        decoded.palette_generation = palette_generation;
     }
+    out_line = decoded.dots;
 }
 
-void engine::tile_line_4bpp(tile_line& out_line, const u32 y, const usize base_addr, const bg_map_entry entry) const noexcept
+void engine::tile_line_4bpp(tile_line& out_line, const u32 y, const usize base_addr, const bg_map_entry entry) noexcept
 {
     constexpr u32 total_tile_size = tile_dot_count * tile_dot_count / 2_u32;
-    for(u32 x = 0_u32; x < tile_dot_count; x += 2_u32) {
-        const u8 color_idxs = memcpy<u8>(vram_, base_addr + entry.tile_idx() * total_tile_size + y * 4_u32 + x / 2_u32);
-        const u8 palette_idx = entry.palette_idx();
-        out_line[x] = palette_color(color_idxs & 0xF_u8, palette_idx);
-        out_line[x + 1_u32] = palette_color(color_idxs >> 4_u8, palette_idx);
+    const usize row_addr = base_addr + entry.tile_idx() * total_tile_size + y * 4_u32;
+    const u8 palette_idx = entry.palette_idx();
+
+    decoded_tile_line& decoded = decoded_lines_4bpp_[row_addr / 4_usize];
+    const u32 vram_generation = vram_generations_[row_addr / dirty_block_size];
+    const u32 palette_generation = palette_generations_[palette_idx];
+    if(decoded.vram_generation != vram_generation || decoded.palette_generation != palette_generation
+      || decoded.palette_idx != palette_idx) {
+        for(u32 x = 0_u32; x < tile_dot_count; x += 2_u32) {
+            const u8 color_idxs = memcpy<u8>(vram_, row_addr + x / 2_u32);
+            decoded.dots[x] = palette_color(color_idxs & 0xF_u8, palette_idx);
+            decoded.dots[x + 1_u32] = palette_color(color_idxs >> 4_u8, palette_idx);
+        }
+        decoded.vram_generation = vram_generation;
+        decoded.palette_generation = palette_generation;
+        decoded.palette_idx = palette_idx;
     }
+    out_line = decoded.dots;
 }
 
 color engine::tile_dot_8bpp(const u32 x, const u32 y, const usize tile_addr, const palette_8bpp_target target) const noexcept
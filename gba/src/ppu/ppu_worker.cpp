@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <gba/ppu/ppu_worker.h>
+
+#include <cstring>
+
+namespace gba::ppu {
+
+scanline_worker::scanline_worker()
+  : renderer_{new engine}
+{
+    thread_ = std::thread{[this]() { worker_loop(); }};
+}
+
+scanline_worker::~scanline_worker()
+{
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    job_available_.notify_one();
+    thread_.join();
+}
+
+void scanline_worker::submit(engine& source)
+{
+    std::unique_lock lock{mutex_};
+    job_done_.wait(lock, [&]() { return job_count_ < jobs_.size(); });
+
+    // the slot is not visible to the worker until the count covers it
+    job& j = jobs_[(first_job_ + job_count_) % jobs_.size()];
+    lock.unlock();
+
+    j.registers = source.save_line_registers();
+    j.block_ids.clear();
+    j.block_data.clear();
+    for(usize block = 0_usize; block < engine::dirty_block_count; ++block) {
+        if(source.dirty_blocks_[block]) {
+            source.dirty_blocks_[block] = false;
+
+            const usize offset = j.block_data.size();
+            j.block_ids.push_back(narrow<u8>(block));
+            j.block_data.resize(offset + engine::dirty_block_size);
+            std::memcpy(j.block_data.ptr(offset), source.dirty_block_data(block), engine::dirty_block_size.get());
+        }
+    }
+
+    lock.lock();
+    ++job_count_;
+    lock.unlock();
+    job_available_.notify_one();
+}
+
+void scanline_worker::wait_idle()
+{
+    std::unique_lock lock{mutex_};
+    job_done_.wait(lock, [&]() { return job_count_ == 0_usize; });
+}
+
+void scanline_worker::worker_loop()
+{
+    while(true) {
+        std::unique_lock lock{mutex_};
+        job_available_.wait(lock, [&]() { return stopping_ || job_count_ != 0_usize; });
+        if(job_count_ == 0_usize) {
+            return;
+        }
+
+        job& j = jobs_[first_job_];
+        lock.unlock();
+
+        render(j);
+
+        lock.lock();
+        first_job_ = (first_job_ + 1_usize) % jobs_.size();
+        --job_count_;
+        lock.unlock();
+        job_done_.notify_all();
+    }
+}
+
+void scanline_worker::render(job& j)
+{
+    for(usize i = 0_usize; i < j.block_ids.size(); ++i) {
+        const usize block{j.block_ids[i]};
+        std::memcpy(renderer_->dirty_block_data(block), j.block_data.ptr(i * engine::dirty_block_size), engine::dirty_block_size.get());
+        renderer_->on_block_write(block);
+    }
+
+    engine& r = *renderer_;
+    r.load_line_registers(j.registers);
+    if(r.dispcnt_.win0_enabled || r.dispcnt_.win1_enabled || r.dispcnt_.win_obj_enabled) {
+        r.generate_window_buffer();
+    }
+    r.render_scanline();
+
+    frame_[r.vcount_] = r.final_buffer_;
+    rendered_lines_[r.vcount_] = true;
+}
+
+} // namespace gba::ppu
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#ifndef GAMEBOIADVANCE_JSON_ESCAPE_H
+#define GAMEBOIADVANCE_JSON_ESCAPE_H
+
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace gba {
+
+// escapes a string so it can be placed between quotes in a json document
+[[nodiscard]] inline std::string json_escape(const std::string_view str)
+{
+    std::string escaped;
+    escaped.reserve(str.size());
+    for(const char c : str) {
+        switch(c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+                } else {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+} // namespace gba
+
+#endif //GAMEBOIADVANCE_JSON_ESCAPE_H
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define HAS_TIMESTAMP_COUNTER 1
+#elif defined(_M_X64) || defined(_M_IX86)
+  #include <intrin.h>
+  #define HAS_TIMESTAMP_COUNTER 1
+#else
+  #define HAS_TIMESTAMP_COUNTER 0
+#endif
+
+#include <cxxopts.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#include <gba/core.h>
+#include <gba/version.h>
+
+#include <json_escape.h>
+
+using namespace gba;
+
+namespace {
+
+struct bench_options {
+    u32 frames;
+    u32 warmup_frames;
+    bool skip_bios;
+    bool native_swi;
+    bool idle_loop_skipping;
+    bool threaded_ppu;
+};
+
+struct bench_result {
+    std::string rom;
+    std::string title;
+    u32 frames;
+    double seconds;
+    u64 guest_cycles;
+    u64 guest_instructions;
+    std::optional<u64> host_cycles;
+    cartridge::pak_load_stats load_stats;
+
+    [[nodiscard]] double frames_per_second() const noexcept { return static_cast<double>(frames.get()) / seconds; }
+    [[nodiscard]] double instructions_per_second() const noexcept { return static_cast<double>(guest_instructions.get()) / seconds; }
+
+    // 1.0 is full speed
+    [[nodiscard]] double speed_ratio() const noexcept
+    {
+        return static_cast<double>(guest_cycles.get()) / static_cast<double>(cpu::clock_speed.get()) / seconds;
+    }
+
+    [[nodiscard]] std::optional<double> host_cycles_per_guest_cycle() const noexcept
+    {
+        if(!host_cycles.has_value() || guest_cycles == 0_u64) {
+            return std::nullopt;
+        }
+        return static_cast<double>(host_cycles->get()) / static_cast<double>(guest_cycles.get());
+    }
+};
+
+[[nodiscard]] std::optional<u64> read_host_cycles() noexcept
+{
+#if HAS_TIMESTAMP_COUNTER
+    return u64{__rdtsc()};
+#else
+    return std::nullopt;
+#endif // HAS_TIMESTAMP_COUNTER
+}
+
+bench_result run(const vector<u8>& bios, const fs::path& rom, const bench_options& options)
+{
+    core core{bios};
+    core.set_native_swi_fast_paths(options.native_swi);
+    core.set_idle_loop_skipping(options.idle_loop_skipping);
+    core.set_threaded_rendering(options.threaded_ppu);
+    core.load_pak(rom);
+    const cartridge::pak_load_stats load_stats = core.pak_load_stats();
+    if(options.skip_bios) {
+        core.skip_bios();
+    }
+
+    for(u32 frame = 0_u32; frame < options.warmup_frames; ++frame) {
+        core.tick_one_frame();
+    }
+
+    const u64 start_cycles = core.elapsed_cycles();
+    const u64 start_instructions = core.executed_instruction_count();
+    const std::optional<u64> start_host_cycles = read_host_cycles();
+    const auto start = std::chrono::steady_clock::now();
+
+    for(u32 frame = 0_u32; frame < options.frames; ++frame) {
+        core.tick_one_frame();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const std::optional<u64> end_host_cycles = read_host_cycles();
+
+    bench_result result;
+    result.rom = rom.string();
+    result.title = std::string{core.game_title()};
+    result.frames = options.frames;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.guest_cycles = core.elapsed_cycles() - start_cycles;
+    result.guest_instructions = core.executed_instruction_count() - start_instructions;
+    result.load_stats = load_stats;
+    if(start_host_cycles.has_value() && end_host_cycles.has_value()) {
+        result.host_cycles = *end_host_cycles - *start_host_cycles;
+    }
+    return result;
+}
+
+void print_text(const vector<bench_result>& results)
+{
+    for(const bench_result& r : results) {
+        fmt::print("{} ({})\n", r.rom, r.title);
+        fmt::print("  load:                {} us ({}, image {} us, backup detection {} us)\n",
+          r.load_stats.total_time.count(), r.load_stats.mapped ? "mapped" : "in memory",
+          r.load_stats.image_time.count(), r.load_stats.backup_detection_time.count());
+        fmt::print("  frames:              {} in {:.3f} s\n", r.frames, r.seconds);
+        fmt::print("  frames/s:            {:.1f}\n", r.frames_per_second());
+        fmt::print("  speed:               {:.2f}x\n", r.speed_ratio());
+        fmt::print("  instructions/s:      {:.0f}\n", r.instructions_per_second());
+        if(const std::optional<double> cpc = r.host_cycles_per_guest_cycle(); cpc.has_value()) {
+            fmt::print("  host cycles/cycle:   {:.2f}\n", *cpc);
+        }
+    }
+}
+
+void print_json(const vector<bench_result>& results, const bench_options& options)
+{
+    fmt::print("{{\n");
+    fmt::print("  \"version\": \"{}\",\n", gba::version);
+    fmt::print("  \"skip_bios\": {},\n", options.skip_bios);
+    fmt::print("  \"native_swi\": {},\n", options.native_swi);
+    fmt::print("  \"idle_loop_skipping\": {},\n", options.idle_loop_skipping);
+    fmt::print("  \"threaded_ppu\": {},\n", options.threaded_ppu);
+    fmt::print("  \"warmup_frames\": {},\n", options.warmup_frames);
+    fmt::print("  \"results\": [");
+    for(usize i = 0_usize; i < results.size(); ++i) {
+        const bench_result& r = results[i];
+        const std::optional<double> cpc = r.host_cycles_per_guest_cycle();
+        fmt::print("{}\n    {{\n", i == 0_usize ? "" : ",");
+        fmt::print("      \"rom\": \"{}\",\n", json_escape(r.rom));
+        fmt::print("      \"title\": \"{}\",\n", json_escape(r.title));
+        fmt::print("      \"rom_size\": {},\n", r.load_stats.rom_size);
+        fmt::print("      \"rom_mapped\": {},\n", r.load_stats.mapped);
+        fmt::print("      \"load_time_us\": {},\n", r.load_stats.total_time.count());
+        fmt::print("      \"image_time_us\": {},\n", r.load_stats.image_time.count());
+        fmt::print("      \"header_time_us\": {},\n", r.load_stats.header_time.count());
+        fmt::print("      \"backup_detection_time_us\": {},\n", r.load_stats.backup_detection_time.count());
+        fmt::print("      \"backup_scan_cached\": {},\n", r.load_stats.backup_scan_cached);
+        fmt::print("      \"frames\": {},\n", r.frames);
+        fmt::print("      \"seconds\": {:.6f},\n", r.seconds);
+        fmt::print("      \"frames_per_second\": {:.3f},\n", r.frames_per_second());
+        fmt::print("      \"speed_ratio\": {:.4f},\n", r.speed_ratio());
+        fmt::print("      \"guest_cycles\": {},\n", r.guest_cycles);
+        fmt::print("      \"guest_instructions\": {},\n", r.guest_instructions);
+        fmt::print("      \"instructions_per_second\": {:.0f},\n", r.instructions_per_second());
+        if(cpc.has_value()) {
+            fmt::print("      \"host_cycles_per_guest_cycle\": {:.4f}\n", *cpc);
+        } else {
+            fmt::print("      \"host_cycles_per_guest_cycle\": null\n");
+        }
+        fmt::print("    }}");
+    }
+    fmt::print("\n  ]\n}}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+#if SPDLOG_ACTIVE_LEVEL != SPDLOG_LEVEL_OFF
+    // keep stdout clean for the report
+    spdlog::set_default_logger(spdlog::stderr_color_st("core"));
+    spdlog::set_level(spdlog::level::warn);
+#endif // SPDLOG_ACTIVE_LEVEL != SPDLOG_LEVEL_OFF
+
+    cxxopts::Options options("gameboiadvance_bench", "Headless throughput benchmark");
+    options
+      .show_positional_help()
+      .add_options()
+        ("h,help", "Show this help text")
+        ("f,frames", "Frames to measure per rom", cxxopts::value<uint32_t>()->default_value("3600"))
+        ("w,warmup", "Frames to run before measuring", cxxopts::value<uint32_t>()->default_value("60"))
+        ("skip-bios", "Skips bios and starts the game directly")
+        ("bios", "BIOS binary path (uses hle bios if not provided)", cxxopts::value<std::string>()->default_value(""))
+        ("native-swi", "Runs BIOS copy and decompression calls natively even with a real BIOS")
+        ("no-idle-skip", "Disables idle loop skipping")
+        ("threaded-ppu", "Renders scanlines on a worker thread")
+        ("json", "Prints the report as json")
+        ("rom-path", "Rom paths", cxxopts::value<std::vector<std::string>>());
+
+    options.parse_positional("rom-path");
+
+    const auto parsed = options.parse(argc, argv);
+    if(parsed["help"].as<bool>() || parsed["rom-path"].count() == 0) {
+        fmt::print("{}", options.help());
+        return EXIT_FAILURE;
+    }
+
+    // an empty bios image makes the core fall back to hle bios
+    vector<u8> bios;
+    if(const fs::path bios_path = parsed["bios"].as<std::string>(); !bios_path.empty()) {
+        if(!fs::exists(bios_path)) {
+            fmt::print(stderr, "bios file not found: {}\n", bios_path.string());
+            return EXIT_FAILURE;
+        }
+        bios = fs::read_file(bios_path);
+    }
+
+    const bench_options bench_options{
+      parsed["frames"].as<uint32_t>(),
+      parsed["warmup"].as<uint32_t>(),
+      parsed["skip-bios"].as<bool>(),
+      parsed["native-swi"].as<bool>(),
+      !parsed["no-idle-skip"].as<bool>(),
+      parsed["threaded-ppu"].as<bool>()
+    };
+
+    vector<bench_result> results;
+    for(const std::string& rom : parsed["rom-path"].as<std::vector<std::string>>()) {
+        if(!fs::exists(rom)) {
+            fmt::print(stderr, "rom not found: {}\n", rom);
+            return EXIT_FAILURE;
+        }
+        results.push_back(run(bios, rom, bench_options));
+    }
+
+    if(parsed["json"].as<bool>()) {
+        print_json(results, bench_options);
+    } else {
+        print_text(results);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <chrono>
+#include <random>
+#include <string_view>
+
+#include <access_private.h>
+
+#include <gba/core.h>
+
+ACCESS_PRIVATE_FIELD(gba::core, gba::cpu::cpu, cpu_)
+ACCESS_PRIVATE_FIELD(gba::cpu::arm7tdmi, gba::cpu::psr, cpsr_)
+ACCESS_PRIVATE_FIELD(gba::cpu::arm7tdmi, gba::cpu::pipeline, pipeline_)
+
+using namespace gba;
+
+namespace {
+
+constexpr usize sample_count = 64_kb;
+constexpr u32 repeat_count = 500_u32;
+constexpr u64 max_traced_cycles = 600_u64 * ppu::engine::cycles_per_frame;
+
+struct sample {
+    cpu::psr flags;
+    u32 cond;
+};
+
+// both sides read the same lazily evaluated flags
+FORCEINLINE bool switch_condition_met(const u32 cond, const cpu::psr& f) noexcept
+{
+    switch(cond.get()) {
+        /* EQ */ case 0x0: return f.z();
+        /* NE */ case 0x1: return !f.z();
+        /* CS */ case 0x2: return f.c();
+        /* CC */ case 0x3: return !f.c();
+        /* MI */ case 0x4: return f.n();
+        /* PL */ case 0x5: return !f.n();
+        /* VS */ case 0x6: return f.v();
+        /* VC */ case 0x7: return !f.v();
+        /* HI */ case 0x8: return f.c() && !f.z();
+        /* LS */ case 0x9: return !f.c() || f.z();
+        /* GE */ case 0xA: return f.n() == f.v();
+        /* LT */ case 0xB: return f.n() != f.v();
+        /* GT */ case 0xC: return !f.z() && f.n() == f.v();
+        /* LE */ case 0xD: return f.z() || f.n() != f.v();
+        /* AL */ case 0xE: return true;
+    }
+
+    // NV
+    return false;
+}
+
+// bit nzcv of an entry is set when the condition passes with those flags
+constexpr array<u16, 16> condition_table{
+  /* EQ */ 0xF0F0_u16, /* NE */ 0x0F0F_u16, /* CS */ 0xCCCC_u16, /* CC */ 0x3333_u16,
+  /* MI */ 0xFF00_u16, /* PL */ 0x00FF_u16, /* VS */ 0xAAAA_u16, /* VC */ 0x5555_u16,
+  /* HI */ 0x0C0C_u16, /* LS */ 0xF3F3_u16, /* GE */ 0xAA55_u16, /* LT */ 0x55AA_u16,
+  /* GT */ 0x0A05_u16, /* LE */ 0xF5FA_u16, /* AL */ 0xFFFF_u16, /* NV */ 0x0000_u16
+};
+
+FORCEINLINE bool table_condition_met(const u32 cond, const cpu::psr& f) noexcept
+{
+    const u32 nzcv = bit::from_bool(f.n()) << 3_u32
+      | bit::from_bool(f.z()) << 2_u32
+      | bit::from_bool(f.c()) << 1_u32
+      | bit::from_bool(f.v());
+    return bit::test(condition_table[usize{cond}], narrow<u8>(nzcv));
+}
+
+sample make_sample(const cpu::psr& flags, const u32 cond) noexcept
+{
+    sample s;
+    s.flags = flags;
+    s.cond = cond;
+    return s;
+}
+
+vector<sample> make_random_samples()
+{
+    std::mt19937 rng{0xC0DE'CAFEu};
+    const auto random_u32 = [&]() { return u32{static_cast<u32::type>(rng())}; };
+
+    vector<sample> samples;
+    samples.reserve(sample_count);
+    for(usize i = 0_usize; i < sample_count; ++i) {
+        cpu::psr flags;
+        const u32 first_op = random_u32();
+        const u32 second_op = rng() % 4 == 0 ? first_op : random_u32(); // make z set every now and then
+        switch(rng() % 3) {
+            case 0: flags.set_add(first_op, second_op, false, first_op + second_op); break;
+            case 1: flags.set_sub(first_op, second_op, true, first_op - second_op); break;
+            default:
+                flags.set_nz(first_op & second_op);
+                flags.set_c(bit::test(first_op, 0_u8));
+                break;
+        }
+
+        samples.push_back(make_sample(flags, u32{static_cast<u32::type>(rng() % 15)})); // conditional and AL instructions
+    }
+    return samples;
+}
+
+// conditions and flags of the first non-AL arm instructions the rom executes
+vector<sample> make_rom_samples(const fs::path& rom)
+{
+    core core{vector<u8>{}};
+    core.load_pak(rom);
+
+    const cpu::cpu& arm = access_private::cpu_(core);
+    vector<sample> samples;
+    samples.reserve(sample_count);
+    while(samples.size() < sample_count && core.elapsed_cycles() < max_traced_cycles) {
+        const cpu::psr& cpsr = access_private::cpsr_(arm);
+        const u32 cond = access_private::pipeline_(arm).executing >> 28_u32;
+        if(!cpsr.t && cond != 0xE_u32) {
+            samples.push_back(make_sample(cpsr, cond));
+        }
+        core.tick(); // one instruction
+    }
+    return samples;
+}
+
+template<typename F>
+double measure(const vector<sample>& samples, u32& passed, F&& condition_met)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    for(u32 r = 0_u32; r < repeat_count; ++r) {
+        for(const sample& s : samples) {
+            passed += bit::from_bool(condition_met(s));
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// checks the switch and the table agree, returns false if they do not
+bool compare(const std::string_view name, const vector<sample>& samples)
+{
+    u32 switch_passed;
+    u32 table_passed;
+    const double switch_time = measure(samples, switch_passed, [](const sample& s) {
+        return switch_condition_met(s.cond, s.flags);
+    });
+    const double table_time = measure(samples, table_passed, [](const sample& s) {
+        return table_condition_met(s.cond, s.flags);
+    });
+
+    if(switch_passed != table_passed) {
+        fmt::print(stderr, "{}: condition results differ: {} != {}\n", name, switch_passed, table_passed);
+        return false;
+    }
+
+    const double checks = static_cast<double>(samples.size().get()) * static_cast<double>(repeat_count.get());
+    fmt::print("{} ({} conditions)\n", name, samples.size());
+    fmt::print("  switch: {:.2f} ns/check\n", switch_time * 1e9 / checks);
+    fmt::print("  table:  {:.2f} ns/check ({:.2f}x)\n", table_time * 1e9 / checks, switch_time / table_time);
+    return true;
+}
+
+} // namespace
+
+// usage: gameboiadvance_microbench [rom path], FuzzARM.gba exercises every condition code
+int main(int argc, char** argv)
+{
+    if(!compare("random", make_random_samples())) {
+        return EXIT_FAILURE;
+    }
+
+    if(argc > 1) {
+        const fs::path rom = argv[1];
+        if(!fs::exists(rom)) {
+            fmt::print(stderr, "rom not found: {}\n", rom.string());
+            return EXIT_FAILURE;
+        }
+
+        const vector<sample> samples = make_rom_samples(rom);
+        if(samples.empty()) {
+            fmt::print(stderr, "{} executed no conditional arm instructions\n", rom.string());
+            return EXIT_FAILURE;
+        }
+        if(!compare(rom.string(), samples)) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <cxxopts.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#include <gba/core_pool.h>
+
+#include <json_escape.h>
+
+using namespace gba;
+
+namespace {
+
+struct scaling_result {
+    u32 cores;
+    double seconds;
+    double frames_per_second; // sum over all cores
+};
+
+scaling_result run(const fs::path& rom, const vector<u8>& bios, const u32 core_count, const u32 frames)
+{
+    core_pool pool{usize{core_count}};
+    for(u32 i = 0_u32; i < core_count; ++i) {
+        core& c = pool.add(bios);
+        c.load_pak(rom);
+    }
+
+    // let every core reach its steady state before measuring
+    pool.tick_frames(10_u32);
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.tick_frames(frames);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return scaling_result{core_count, seconds, static_cast<double>(frames.get()) * static_cast<double>(core_count.get()) / seconds};
+}
+
+} // namespace
+
+// runs 1..N cores of a rom on as many threads and reports how the throughput scales
+int main(int argc, char** argv)
+{
+#if SPDLOG_ACTIVE_LEVEL != SPDLOG_LEVEL_OFF
+    spdlog::set_default_logger(spdlog::stderr_color_mt("core"));
+    spdlog::set_level(spdlog::level::warn);
+#endif // SPDLOG_ACTIVE_LEVEL != SPDLOG_LEVEL_OFF
+
+    cxxopts::Options options("gameboiadvance_scaling_bench", "Multi instance scaling benchmark");
+    options
+      .show_positional_help()
+      .add_options()
+        ("h,help", "Show this help text")
+        ("f,frames", "Frames to measure per core", cxxopts::value<uint32_t>()->default_value("600"))
+        ("n,max-cores", "Largest core count to measure (0 picks the hardware concurrency)", cxxopts::value<uint32_t>()->default_value("0"))
+        ("json", "Prints the report as json")
+        ("rom-path", "Rom path", cxxopts::value<std::string>());
+
+    options.parse_positional("rom-path");
+
+    const auto parsed = options.parse(argc, argv);
+    if(parsed["help"].as<bool>() || parsed["rom-path"].count() == 0) {
+        fmt::print("{}", options.help());
+        return EXIT_FAILURE;
+    }
+
+    const fs::path rom = parsed["rom-path"].as<std::string>();
+    if(!fs::exists(rom)) {
+        fmt::print(stderr, "rom not found: {}\n", rom.string());
+        return EXIT_FAILURE;
+    }
+
+    u32 max_cores = parsed["max-cores"].as<uint32_t>();
+    if(max_cores == 0_u32) {
+        max_cores = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const u32 frames = parsed["frames"].as<uint32_t>();
+
+    // empty bios image, every core runs the hle bios
+    const vector<u8> bios;
+
+    vector<scaling_result> results;
+    for(u32 core_count = 1_u32; core_count <= max_cores; ++core_count) {
+        results.push_back(run(rom, bios, core_count, frames));
+    }
+
+    const double single_core_fps = results.front().frames_per_second;
+    if(parsed["json"].as<bool>()) {
+        fmt::print("{{\n  \"rom\": \"{}\",\n  \"frames\": {},\n  \"results\": [", json_escape(rom.filename().string()), frames);
+        for(usize i = 0_usize; i < results.size(); ++i) {
+            const scaling_result& r = results[i];
+            fmt::print("{}\n    {{\"cores\": {}, \"seconds\": {:.6f}, \"frames_per_second\": {:.3f}, \"efficiency\": {:.4f}}}",
+              i == 0_usize ? "" : ",", r.cores, r.seconds, r.frames_per_second,
+              r.frames_per_second / (single_core_fps * r.cores.get()));
+        }
+        fmt::print("\n  ]\n}}\n");
+    } else {
+        fmt::print("{:>6} {:>12} {:>12} {:>10}\n", "cores", "frames/s", "speedup", "efficiency");
+        for(const scaling_result& r : results) {
+            fmt::print("{:>6} {:>12.1f} {:>11.2f}x {:>9.1f}%\n", r.cores, r.frames_per_second,
+              r.frames_per_second / single_core_fps,
+              100.0 * r.frames_per_second / (single_core_fps * r.cores.get()));
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -61,7 +61,7 @@ ACCESS_PRIVATE_FIELD(gba::cpu::cpu, gba::vector<gba::u8>, iwram_)
 ACCESS_PRIVATE_FIELD(gba::cpu::cpu, gba::vector<gba::u8>, wram_)
 ACCESS_PRIVATE_FIELD(gba::cpu::cpu, gba::vector<gba::u8>, bios_)
 
-ACCESS_PRIVATE_FIELD(gba::cartridge::gamepak, gba::vector<gba::u8>, pak_data_)
+ACCESS_PRIVATE_FIELD(gba::cartridge::gamepak, std::shared_ptr<const gba::cartridge::rom_image>, pak_data_)
 ACCESS_PRIVATE_FIELD(gba::cartridge::gamepak, gba::u32, mirror_mask_)
 
 namespace gba::debugger {
@@ -84,10 +84,10 @@ void draw_psr_tooltip(const cpu::psr& p) noexcept
 {
     if(ImGui::IsItemHovered()) {
         ImGui::BeginTooltip();
-        ImGui::Text("n: {}", p.n);  // signed flag
-        ImGui::Text("z: {}", p.z);  // zero flag
-        ImGui::Text("c: {}", p.c);  // carry flag
-        ImGui::Text("v: {}", p.v);  // overflow flag
+        ImGui::Text("n: {}", p.n());  // signed flag
+        ImGui::Text("z: {}", p.z());  // zero flag
+        ImGui::Text("c: {}", p.c());  // carry flag
+        ImGui::Text("v: {}", p.v());  // overflow flag
         ImGui::Text("i: {}", p.i);  // irq disabled flag
         ImGui::Text("f: {}", p.f);  // fiq disabled flag
         ImGui::Text("t: {}", p.t);  // thumb mode flag
@@ -837,29 +837,29 @@ void cpu_debugger::draw_access_breakpoints() noexcept
 void cpu_debugger::draw_disassembly() noexcept
 {
     if(ImGui::BeginChild("#armdisassemblychild")) {
-        vector<u8>* memory;
+        view<u8> memory{nullptr, 0_usize};
         const u32 pc = access_private::r_(cpu_)[15_u32];
         u32 offset;
         u32 mask = access_private::mirror_mask_(gamepak_);
         if(pc < 0x0000'3FFF_u32) {
-            memory = &access_private::bios_(cpu_);
+            memory = view<u8>{access_private::bios_(cpu_)};
             mask = 0x0000'3FFF_u32;
         } else if(pc < 0x0300'0000_u32) {
-            memory = &access_private::wram_(cpu_);
+            memory = view<u8>{access_private::wram_(cpu_)};
             offset = 0x0200'0000_u32;
             mask = 0x0003'FFFF_u32;
         } else if(pc < 0x0400'0000_u32) {
-            memory = &access_private::iwram_(cpu_);
+            memory = view<u8>{access_private::iwram_(cpu_)};
             offset = 0x0300'0000_u32;
             mask = 0x0000'7FFF_u32;
         } else if(pc < 0x0A00'0000_u32) {
-            memory = &access_private::pak_data_(gamepak_);
+            memory = view<u8>{*access_private::pak_data_(gamepak_)};
             offset = 0x0800'0000_u32;
         } else if(pc < 0x0C00'0000_u32) {
-            memory = &access_private::pak_data_(gamepak_);
+            memory = view<u8>{*access_private::pak_data_(gamepak_)};
             offset = 0x0A00'0000_u32;
         } else if(pc < 0x0E00'0000_u32) {
-            memory = &access_private::pak_data_(gamepak_);
+            memory = view<u8>{*access_private::pak_data_(gamepak_)};
             offset = 0x0C00'0000_u32;
         } else {
             // probably something is broken at this point
@@ -879,7 +879,7 @@ void cpu_debugger::draw_disassembly() noexcept
             instr_idx -= 9_u32;
         }
 
-        const usize max = std::min(15_usize + instr_idx, memory->size() / instr_width);
+        const usize max = std::min(15_usize + instr_idx, memory.size() / instr_width);
         for(; instr_idx < max; ++instr_idx) {
             const u32 physical_address = instr_width * narrow<u32>(instr_idx);
             const u32 virtual_address = physical_address + offset;
@@ -887,8 +887,8 @@ void cpu_debugger::draw_disassembly() noexcept
             const bool is_thumb = access_private::cpsr_(cpu_).t;
             const bool is_pc = virtual_address == pc_physical_address + offset - (2_u32 * instr_width);
             const u32 instr = is_thumb
-              ? memcpy<u16>(*memory, physical_address)
-              : memcpy<u32>(*memory, physical_address);
+              ? memcpy<u16>(memory, physical_address)
+              : memcpy<u32>(memory, physical_address);
 
             disassembly_entry entry{bp_db_, virtual_address, instr, is_thumb, is_pc};
             entry.draw();
@@ -35,12 +35,11 @@ ACCESS_PRIVATE_FIELD(gba::core, gba::keypad::keypad, keypad_)
 ACCESS_PRIVATE_FIELD(gba::cpu::arm7tdmi, gba::cpu::psr, cpsr_)
 ACCESS_PRIVATE_FIELD(gba::cpu::cpu, gba::vector<gba::u8>, wram_)
 ACCESS_PRIVATE_FIELD(gba::cpu::cpu, gba::vector<gba::u8>, iwram_)
-ACCESS_PRIVATE_FIELD(gba::cartridge::gamepak, gba::vector<gba::u8>, pak_data_)
+ACCESS_PRIVATE_FIELD(gba::cartridge::gamepak, std::shared_ptr<const gba::cartridge::rom_image>, pak_data_)
 ACCESS_PRIVATE_FIELD(gba::cartridge::gamepak, std::unique_ptr<gba::cartridge::backup>, backup_)
 ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::vector<gba::u8>, palette_ram_)
 ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::vector<gba::u8>, vram_)
 ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::vector<gba::u8>, oam_)
-ACCESS_PRIVATE_FIELD(gba::scheduler, gba::vector<gba::scheduler::hw_event>, heap_)
 
 namespace gba::debugger {
 
@@ -308,7 +307,7 @@ bool window::draw() noexcept
     keypad_debugger_.draw();
 
     if(ImGui::Begin("Scheduler", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-        vector<scheduler::hw_event> events = access_private::heap_(scheduler_);
+        vector<scheduler::hw_event> events = scheduler_->pending_events();
         std::sort(events.begin(), events.end(), [](const scheduler::hw_event& e1, const scheduler::hw_event& e2) {
             return e1.timestamp < e2.timestamp;
         });
@@ -319,7 +318,7 @@ bool window::draw() noexcept
         ImGui::Spacing();
         ImGui::Spacing();
 
-        const hw_event_registry& registry = hw_event_registry::get();
+        const hw_event_registry& registry = scheduler_->event_registry();
         for(const scheduler::hw_event& event : events) {
             const hw_event_registry::entry* entry = registry.find_by_callback(event.callback);
             ImGui::Text("{}, timestamp: {} ({})", entry ? entry->name : "????",
@@ -594,8 +593,8 @@ void window::generate_memory_debugger_entries() noexcept
     ppu::engine& ppu_engine = access_private::ppu_engine_(core_);
 
     if(pak.loaded()) {
-        disassembly_view_.add_entry<memory_view_entry>("ROM", view<u8>{access_private::pak_data_(pak)}, 0x0800'0000_u32);
-        memory_view_.add_entry(memory_view_entry{"ROM", view<u8>{access_private::pak_data_(pak)}, 0x0800'0000_u32});
+        disassembly_view_.add_entry<memory_view_entry>("ROM", view<u8>{*access_private::pak_data_(pak)}, 0x0800'0000_u32);
+        memory_view_.add_entry(memory_view_entry{"ROM", view<u8>{*access_private::pak_data_(pak)}, 0x0800'0000_u32});
     }
 
     disassembly_view_.add_entry<memory_view_entry>("EWRAM", view<u8>{access_private::wram_(cpu_)}, 0x0200'0000_u32);
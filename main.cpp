@@ -14,6 +14,7 @@
 #include <spdlog/spdlog.h>
 #include <sdl2cpp/sdl_core.h>
 
+#include <gba/cartridge/gamepak_db.h>
 #include <gba/core.h>
 #include <gba/version.h>
 
@@ -49,7 +50,11 @@ int main(int argc, char** argv)
         ("V,initial-volume", "Initial volume of the frontend", cxxopts::value<float>()->default_value("0.7"))
         ("skip-bios", "Skips bios and starts the game directly")
 #endif // WITH_DEBUGGGER
-        ("bios", "BIOS binary path (looks for bios.bin if not provided)", cxxopts::value<std::string>()->default_value("bios.bin"))
+        ("bios", "BIOS binary path (looks for bios.bin if not provided, falls back to hle bios if not found)", cxxopts::value<std::string>()->default_value("bios.bin"))
+        ("native-swi", "Runs BIOS copy and decompression calls natively even with a real BIOS")
+        ("threaded-ppu", "Renders scanlines on a worker thread")
+        ("idle-skip", "Skips detected idle loops to the next scheduled event")
+        ("pak-db", "External pak database overriding the built-in one (looks for pak_db.bin if not provided)", cxxopts::value<std::string>()->default_value("pak_db.bin"))
         ("rom-path", "Rom path or directory", cxxopts::value<std::vector<std::string>>());
 
     options.parse_positional("rom-path");
@@ -74,15 +79,25 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
+    // an empty bios image makes the core fall back to hle bios
+    gba::vector<gba::u8> bios;
     const gba::fs::path bios_path = parsed["bios"].as<std::string>();
-    if(!gba::fs::exists(bios_path) || gba::fs::is_empty(bios_path)) {
-        fmt::print("bios file not found or empty: {}\n{}", bios_path.string(), options.help());
-        return EXIT_FAILURE;
+    if(gba::fs::exists(bios_path) && !gba::fs::is_empty(bios_path)) {
+        bios = gba::fs::read_file(bios_path);
+    } else {
+        fmt::print("bios file not found or empty: {}, using hle bios\n", bios_path.string());
+    }
+
+    if(const gba::fs::path pak_db_path = parsed["pak-db"].as<std::string>(); gba::fs::exists(pak_db_path)) {
+        gba::cartridge::load_pak_db_overlay(pak_db_path);
     }
 
     sdl::init();
 
-    gba::core core{gba::fs::read_file(bios_path)};
+    gba::core core{std::move(bios)};
+    core.set_native_swi_fast_paths(parsed["native-swi"].as<bool>());
+    core.set_threaded_rendering(parsed["threaded-ppu"].as<bool>());
+    core.set_idle_loop_skipping(parsed["idle-skip"].as<bool>());
     core.load_pak(parsed["rom-path"].as<std::vector<std::string>>().front());
 
     const auto cleanup_and_exit = []() {
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+
+#include <access_private.h>
+
+#include <gba/core.h>
+#include <gba/core_pool.h>
+#include <test_prelude.h>
+
+namespace {
+
+using regs_t = gba::array<gba::u32, 16>;
+
+} // namespace
+
+ACCESS_PRIVATE_FIELD(gba::core, gba::cpu::cpu, cpu_)
+ACCESS_PRIVATE_FIELD(gba::cpu::arm7tdmi, regs_t, r_)
+ACCESS_PRIVATE_FIELD(gba::cpu::cpu, gba::vector<gba::u8>, wram_)
+
+using namespace gba;
+
+TEST_CASE("core pool")
+{
+    const fs::path res = fs::current_path() / "res";
+    const array<fs::path, 4> roms{
+      res / "ARM_Any.gba", res / "THUMB_Any.gba", res / "ARM_DataProcessing.gba", res / "THUMB_DataProcessing.gba"
+    };
+
+    core_pool pool{3_usize};
+    for(const fs::path& rom : roms) {
+        pool.add(vector<u8>{}).load_pak(rom);
+    }
+    // a second instance of the same game
+    pool.add(vector<u8>{}).load_pak(roms[0_usize]);
+
+    // instances of the same game do not share a backup file
+    CHECK(fs::exists(res / "backups" / "ARM_Any.0.sav"));
+    CHECK(fs::exists(res / "backups" / "ARM_Any.4.sav"));
+
+    constexpr u32 frame_count = 30_u32;
+    for(u32 frame = 0_u32; frame < frame_count; frame += 10_u32) {
+        pool.tick_frames(10_u32);
+    }
+
+    // every instance runs exactly as it would alone
+    for(usize i = 0_usize; i < pool.size(); ++i) {
+        core alone{vector<u8>{}};
+        alone.load_pak(roms[i % roms.size()]);
+        for(u32 frame = 0_u32; frame < frame_count; ++frame) {
+            alone.tick_one_frame();
+        }
+
+        auto& arm = access_private::cpu_(pool[i]);
+        const regs_t& regs = access_private::r_(arm);
+        const regs_t& regs_alone = access_private::r_(access_private::cpu_(alone));
+        CHECK(access_private::wram_(arm)[0_usize] == 0_u8);
+        CHECK(std::equal(regs.begin(), regs.end(), regs_alone.begin()));
+        CHECK(pool[i].executed_instruction_count() == alone.executed_instruction_count());
+        CHECK(pool[i].elapsed_cycles() == alone.elapsed_cycles());
+    }
+}
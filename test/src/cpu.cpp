@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <access_private.h>
+
+#include <gba/core.h>
+#include <test_prelude.h>
+
+namespace {
+
+using regs_t = gba::array<gba::u32, 16>;
+
+} // namespace
+
+ACCESS_PRIVATE_FIELD(gba::core, gba::cpu::cpu, cpu_)
+ACCESS_PRIVATE_FIELD(gba::cpu::arm7tdmi, regs_t, r_)
+
+using namespace gba;
+
+TEST_CASE("idle loop skipping")
+{
+    // counts vblanks in r2 by polling vcount
+    constexpr array<u32, 9> program{
+      0xE3A0'1301_u32, //     mov r1, #0x04000000
+      0xE1D1'00B6_u32, // l0: ldrh r0, [r1, #6]
+      0xE350'00A0_u32, //     cmp r0, #160
+      0x1AFF'FFFC_u32, //     bne l0
+      0xE282'2001_u32, //     add r2, r2, #1
+      0xE1D1'00B6_u32, // l1: ldrh r0, [r1, #6]
+      0xE350'00A0_u32, //     cmp r0, #160
+      0x0AFF'FFFC_u32, //     beq l1
+      0xEAFF'FFF7_u32, //     b l0
+    };
+
+    vector<u8> rom{0x200_usize};
+    for(usize i = 0_usize; i < program.size(); ++i) {
+        memcpy(rom, i * 4_usize, program[i]);
+    }
+
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_idle_loop";
+    fs::create_directories(dir);
+    const fs::path rom_path = dir / "idle_loop.gba";
+    fs::write_file(rom_path, rom);
+
+    const auto run = [&](const bool skip_idle_loops) {
+        core g{vector<u8>{16_kb}};
+        g.load_pak(rom_path);
+        g.skip_bios();
+        g.set_idle_loop_skipping(skip_idle_loops);
+
+        for(int i = 0; i < 10; ++i) {
+            g.tick_one_frame();
+        }
+
+        CHECK((g.idle_loop_stats().skip_count != 0_u64) == skip_idle_loops);
+        return access_private::r_(access_private::cpu_(g))[2_u32];
+    };
+
+    const u32 counted = run(false);
+    CHECK(counted == 10_u32);
+    CHECK(run(true) == counted);
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <access_private.h>
+
+#include <gba/core.h>
+#include <test_prelude.h>
+
+ACCESS_PRIVATE_FIELD(gba::core, gba::scheduler, scheduler_)
+ACCESS_PRIVATE_FIELD(gba::core, gba::apu::engine, apu_engine_)
+ACCESS_PRIVATE_FIELD(gba::apu::engine, gba::apu::fifo, fifo_a_)
+
+using namespace gba;
+
+TEST_CASE("dma block transfers")
+{
+    core g{vector<u8>{}};
+    g.load_pak(fs::current_path() / "res" / "ARM_Any.gba");
+    g.skip_bios();
+
+    auto& bus = static_cast<cpu::bus_interface&>(g);
+    constexpr cpu::mem_access seq = cpu::mem_access::seq;
+    constexpr cpu::mem_access none = cpu::mem_access::none;
+
+    // runs dma3 to completion, returns the cycles it took
+    const auto run_dma = [&](const u32 src, const u32 dst, const u32 cnt) {
+        bus.write_32(0x0400'00D4_u32, src, seq);
+        bus.write_32(0x0400'00D8_u32, dst, seq);
+        const u64 start = access_private::scheduler_(g).now();
+        bus.write_32(0x0400'00DC_u32, cnt, seq);
+        while(bit::test(bus.read_16(0x0400'00DE_u32, none), 15_u8)) {
+            bus.idle();
+        }
+        return access_private::scheduler_(g).now() - start;
+    };
+
+    for(u32 i = 0_u32; i < 0x300_u32; ++i) {
+        bus.write_32(0x0200'2000_u32 + i * 4_u32, i * 0x0101'0101_u32, seq);
+    }
+
+    // overlapping transfers are done unit by unit, both must take the same time
+    const u64 block_cycles = run_dma(0x0200'2000_u32, 0x0200'0000_u32, 0x8400'0100_u32);
+    const u64 unit_cycles = run_dma(0x0200'2000_u32, 0x0200'1F00_u32, 0x8400'0100_u32);
+    CHECK(block_cycles == unit_cycles);
+
+    for(u32 i = 0_u32; i < 0x100_u32; ++i) {
+        CHECK(bus.read_32(0x0200'0000_u32 + i * 4_u32, none) == i * 0x0101'0101_u32);
+        CHECK(bus.read_32(0x0200'1F00_u32 + i * 4_u32, none) == i * 0x0101'0101_u32);
+    }
+
+    // fixed source fills the destination with one value
+    bus.write_16(0x0200'3000_u32, 0xBEEF_u16, seq);
+    run_dma(0x0200'3000_u32, 0x0600'0000_u32, 0x8100'0040_u32);
+    for(u32 addr = 0x0600'0000_u32; addr < 0x0600'0080_u32; addr += 2_u32) {
+        CHECK(bus.read_16(addr, none) == 0xBEEF_u16);
+    }
+    CHECK(bus.read_16(0x0600'0080_u32, none) != 0xBEEF_u16);
+}
+
+TEST_CASE("sound fifo dma")
+{
+    core g{vector<u8>{}};
+    g.load_pak(fs::current_path() / "res" / "ARM_Any.gba");
+    g.skip_bios();
+
+    auto& bus = static_cast<cpu::bus_interface&>(g);
+    constexpr cpu::mem_access seq = cpu::mem_access::seq;
+
+    for(u32 i = 0_u32; i < 0x400_u32; i += 4_u32) {
+        bus.write_32(0x0200'0000_u32 + i, i * 0x0101'0101_u32 + 0x0302'0100_u32, seq);
+    }
+
+    bus.write_16(0x0400'0084_u32, 0x0080_u16, seq); // sound on
+    bus.write_16(0x0400'0082_u32, 0x0800_u16, seq); // fifo a on timer 0, reset
+    bus.write_32(0x0400'00BC_u32, 0x0200'0000_u32, seq);
+    bus.write_32(0x0400'00C0_u32, 0x0400'00A0_u32, seq);
+    bus.write_32(0x0400'00C4_u32, 0xB600'0004_u32, seq); // dma1, sound fifo, repeat, 32 bit
+    bus.write_32(0x0400'0100_u32, 0x0080'FF00_u32, seq); // timer 0 overflows every 256 cycles
+
+    for(u32 i = 0_u32; i < 100_u32 * 256_u32; ++i) {
+        bus.idle();
+    }
+
+    // refills arrive in order, however many were batched
+    apu::fifo& fifo = access_private::fifo_a_(access_private::apu_engine_(g));
+    REQUIRE(fifo.size() != 0_u32);
+    u8 expected = fifo.latch() + 1_u8;
+    while(fifo.size() != 0_u32) {
+        const u8 sample = fifo.read();
+        CHECK(sample == expected);
+        expected = sample + 1_u8;
+    }
+
+    // a refill larger than the free space is cut short
+    fifo.reset();
+    const array<u8, 48> samples{};
+    fifo.write_samples(view<u8>{samples});
+    CHECK(fifo.size() == 32_u32);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <gba/cartridge/gamepak_db.h>
+#include <test_prelude.h>
+
+using namespace gba;
+using namespace gba::cartridge;
+
+TEST_CASE("pak db")
+{
+    SUBCASE("built-in") {
+        const std::optional<pak_db_entry> emerald = query_pak_db("BPEE");
+        REQUIRE(emerald.has_value());
+        CHECK(emerald->backup_type == backup::type::flash_128);
+        CHECK(emerald->has_rtc);
+        CHECK_FALSE(emerald->has_mirroring);
+
+        const std::optional<pak_db_entry> castlevania = query_pak_db("FADE");
+        REQUIRE(castlevania.has_value());
+        CHECK(castlevania->backup_type == backup::type::eeprom_4);
+        CHECK(castlevania->has_mirroring);
+
+        CHECK_FALSE(query_pak_db("ZZZZ").has_value());
+        CHECK_FALSE(query_pak_db("").has_value());
+    }
+
+    SUBCASE("overlay") {
+        const fs::path dir = fs::temp_directory_path() / "gameboiadvance_pak_db";
+        fs::create_directories(dir);
+        const fs::path path = dir / "pak_db.bin";
+
+        vector<pak_db_entry> entries;
+        entries.push_back(pak_db_entry{"ZZZZ", backup::type::flash_64, false, true});
+        entries.push_back(pak_db_entry{"BPEE", backup::type::sram, false, false});
+        entries.push_back(pak_db_entry{"AAAA", backup::type::none, true, false});
+        write_pak_db(path, entries);
+
+        REQUIRE(load_pak_db_overlay(path));
+
+        const std::optional<pak_db_entry> added = query_pak_db("ZZZZ");
+        REQUIRE(added.has_value());
+        CHECK(added->backup_type == backup::type::flash_64);
+        CHECK(added->has_mirroring);
+
+        const std::optional<pak_db_entry> overridden = query_pak_db("BPEE");
+        REQUIRE(overridden.has_value());
+        CHECK(overridden->backup_type == backup::type::sram);
+        CHECK_FALSE(overridden->has_rtc);
+
+        const std::optional<pak_db_entry> first = query_pak_db("AAAA");
+        REQUIRE(first.has_value());
+        CHECK(first->has_rtc);
+
+        // not in the overlay, falls through to the built-in entries
+        REQUIRE(query_pak_db("FADE").has_value());
+        CHECK(query_pak_db("FADE")->backup_type == backup::type::eeprom_4);
+
+        clear_pak_db_overlay();
+        CHECK(query_pak_db("BPEE")->backup_type == backup::type::flash_128);
+        CHECK_FALSE(query_pak_db("ZZZZ").has_value());
+
+        // anything else than a complete database is rejected
+        fs::resize_file(path, fs::file_size(path) - 1u);
+        CHECK_FALSE(load_pak_db_overlay(path));
+        fs::write_file(path, vector<u8>(32_usize, 0x41_u8));
+        CHECK_FALSE(load_pak_db_overlay(path));
+        CHECK_FALSE(query_pak_db("ZZZZ").has_value());
+
+        fs::remove_all(dir);
+    }
+}
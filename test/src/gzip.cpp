@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+
+#include <gba/helper/gzip.h>
+#include <test_prelude.h>
+
+using namespace gba;
+
+namespace {
+
+vector<u8> make_payload(const usize size)
+{
+    vector<u8> payload{size};
+    u32 state = 0x1234'5678_u32;
+    for(u8& byte : payload) {
+        state = state * 1103515245_u32 + 12345_u32;
+        // keep it compressible but not trivially so
+        byte = narrow<u8>((state >> 16_u32) & 0x0F_u32);
+    }
+    return payload;
+}
+
+bool equal(const vector<u8>& lhs, const vector<u8>& rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+} // namespace
+
+TEST_CASE("gzip streaming decompression")
+{
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_gzip";
+    fs::create_directories(dir);
+    const fs::path path = dir / "payload.gz";
+
+    const vector<u8> first = make_payload(300_kb);
+    const vector<u8> second = make_payload(7_kb);
+    const vector<u8> first_compressed = gzip::compress(first).value();
+
+    SUBCASE("single member") {
+        fs::write_file(path, first_compressed);
+
+        usize chunk_bytes;
+        const std::optional<vector<u8>> inflated = gzip::decompress_file(path, 1_kb * 1_kb,
+          [&](const view<u8> chunk) { chunk_bytes += chunk.size(); });
+        REQUIRE(inflated.has_value());
+        CHECK(equal(*inflated, first));
+        CHECK(chunk_bytes == first.size());
+
+        const std::optional<vector<u8>> from_memory = gzip::decompress(first_compressed);
+        REQUIRE(from_memory.has_value());
+        CHECK(equal(*from_memory, first));
+    }
+
+    SUBCASE("multiple members") {
+        vector<u8> concatenated = first_compressed;
+        const vector<u8> second_compressed = gzip::compress(second).value();
+        for(const u8 byte : second_compressed) {
+            concatenated.push_back(byte);
+        }
+        fs::write_file(path, concatenated);
+
+        // the trailer only describes the last member
+        const std::optional<vector<u8>> inflated = gzip::decompress_file(path, 1_kb * 1_kb);
+        REQUIRE(inflated.has_value());
+        REQUIRE(inflated->size() == first.size() + second.size());
+        CHECK(std::equal(first.begin(), first.end(), inflated->begin()));
+        CHECK(std::equal(second.begin(), second.end(), inflated->ptr(first.size())));
+    }
+
+    SUBCASE("size limit") {
+        fs::write_file(path, first_compressed);
+        CHECK_FALSE(gzip::decompress_file(path, 64_kb).has_value());
+    }
+
+    SUBCASE("exactly at the size limit") {
+        // pad the header with a file name so that the 8 byte trailer lands in an input chunk of its own,
+        // the output is full by the time it is read
+        vector<u8> padded;
+        for(usize i = 0_usize; i < 10_usize; ++i) {
+            padded.push_back(first_compressed[i]);
+        }
+        padded[3_usize] |= 0x08_u8; // FNAME
+        const usize::type name_size = (65536u + 8u - (first_compressed.size().get() + 1u) % 65536u) % 65536u;
+        for(usize::type i = 0u; i < name_size; ++i) {
+            padded.push_back(0x61_u8);
+        }
+        padded.push_back(0x00_u8);
+        for(usize i = 10_usize; i < first_compressed.size(); ++i) {
+            padded.push_back(first_compressed[i]);
+        }
+        REQUIRE(padded.size() % 64_kb == 8_usize);
+        fs::write_file(path, padded);
+
+        const std::optional<vector<u8>> inflated = gzip::decompress_file(path, first.size());
+        REQUIRE(inflated.has_value());
+        CHECK(equal(*inflated, first));
+        CHECK_FALSE(gzip::decompress_file(path, first.size() - 1_usize).has_value());
+    }
+
+    SUBCASE("truncated") {
+        fs::write_file(path, view<u8>{first_compressed.data(), first_compressed.size() / 2_usize});
+        CHECK_FALSE(gzip::decompress_file(path, 1_kb * 1_kb).has_value());
+    }
+
+    fs::remove_all(dir);
+}
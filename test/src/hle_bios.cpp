@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <access_private.h>
+
+#include <gba/core.h>
+#include <test_prelude.h>
+
+namespace {
+
+using regs_t = gba::array<gba::u32, 16>;
+
+} // namespace
+
+ACCESS_PRIVATE_FIELD(gba::core, gba::cpu::cpu, cpu_)
+ACCESS_PRIVATE_FIELD(gba::cpu::arm7tdmi, regs_t, r_)
+
+using namespace gba;
+
+TEST_CASE("hle bios")
+{
+    constexpr array<u32, 28> program{
+      0xE3A0'0064_u32, //     mov r0, #100
+      0xE3A0'1007_u32, //     mov r1, #7
+      0xEF06'0000_u32, //     swi #0x06 ; Div
+      0xE1A0'4000_u32, //     mov r4, r0
+      0xE1A0'5001_u32, //     mov r5, r1
+      0xE3A0'0090_u32, //     mov r0, #144
+      0xEF08'0000_u32, //     swi #0x08 ; Sqrt
+      0xE1A0'6000_u32, //     mov r6, r0
+      0xE3A0'1301_u32, //     mov r1, #0x04000000
+      0xE28F'0024_u32, //     add r0, pc, #0x24 ; irq
+      0xE501'0004_u32, //     str r0, [r1, #-4]
+      0xE3A0'0008_u32, //     mov r0, #8
+      0xE1C1'00B4_u32, //     strh r0, [r1, #4] ; DISPSTAT vblank irq
+      0xE3A0'0001_u32, //     mov r0, #1
+      0xE281'2C02_u32, //     add r2, r1, #0x200
+      0xE1C2'00B0_u32, //     strh r0, [r2] ; IE
+      0xE5C2'0008_u32, //     strb r0, [r2, #8] ; IME
+      0xEF05'0000_u32, // l0: swi #0x05 ; VBlankIntrWait
+      0xE287'7001_u32, //     add r7, r7, #1
+      0xEAFF'FFFC_u32, //     b l0
+      0xE3A0'1301_u32, // irq: mov r1, #0x04000000
+      0xE3A0'0001_u32, //     mov r0, #1
+      0xE281'2C02_u32, //     add r2, r1, #0x200
+      0xE1C2'00B2_u32, //     strh r0, [r2, #2] ; IF
+      0xE151'20B8_u32, //     ldrh r2, [r1, #-8]
+      0xE382'2001_u32, //     orr r2, r2, #1
+      0xE141'20B8_u32, //     strh r2, [r1, #-8] ; bios irq flags
+      0xE12F'FF1E_u32, //     bx lr
+    };
+
+    vector<u8> rom{0x200_usize};
+    for(usize i = 0_usize; i < program.size(); ++i) {
+        memcpy(rom, i * 4_usize, program[i]);
+    }
+
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_hle_bios";
+    fs::create_directories(dir);
+    const fs::path rom_path = dir / "hle_bios.gba";
+    fs::write_file(rom_path, rom);
+
+    core g{vector<u8>{}};
+    g.load_pak(rom_path);
+
+    for(int i = 0; i < 10; ++i) {
+        g.tick_one_frame();
+    }
+
+    const auto& r = access_private::r_(access_private::cpu_(g));
+    CHECK(r[4_u32] == 14_u32);
+    CHECK(r[5_u32] == 2_u32);
+    CHECK(r[6_u32] == 12_u32);
+    CHECK(r[7_u32] >= 9_u32);
+    CHECK(r[7_u32] <= 10_u32);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("hle bios skips unimplemented swis")
+{
+    constexpr array<u32, 4> program{
+      0xE3A0'0005_u32, // mov r0, #5
+      0xEF1A'0000_u32, // swi #0x1A ; SoundDriverInit
+      0xE280'0001_u32, // add r0, r0, #1
+      0xEAFF'FFFE_u32, // b .
+    };
+
+    vector<u8> rom{0x200_usize};
+    for(usize i = 0_usize; i < program.size(); ++i) {
+        memcpy(rom, i * 4_usize, program[i]);
+    }
+
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_hle_unimplemented";
+    fs::create_directories(dir);
+    const fs::path rom_path = dir / "hle_unimplemented.gba";
+    fs::write_file(rom_path, rom);
+
+    core g{vector<u8>{}};
+    g.load_pak(rom_path);
+    g.tick_one_frame();
+
+    CHECK(access_private::r_(access_private::cpu_(g))[0_u32] == 6_u32);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("hle bios unpacking and unfiltering")
+{
+    constexpr array<u32, 12> program{
+      0xE3A0'0302_u32, // mov r0, #0x08000000
+      0xE280'0C01_u32, // add r0, r0, #0x100
+      0xE3A0'1402_u32, // mov r1, #0x02000000
+      0xE3A0'2302_u32, // mov r2, #0x08000000
+      0xE282'2E11_u32, // add r2, r2, #0x110
+      0xEF10'0000_u32, // swi #0x10 ; BitUnPack
+      0xE3A0'0302_u32, // mov r0, #0x08000000
+      0xE280'0E12_u32, // add r0, r0, #0x120
+      0xE3A0'1402_u32, // mov r1, #0x02000000
+      0xE281'1C01_u32, // add r1, r1, #0x100
+      0xEF16'0000_u32, // swi #0x16 ; Diff8bitUnFilterWram
+      0xEAFF'FFFE_u32, // b .
+    };
+
+    vector<u8> rom{0x200_usize};
+    for(usize i = 0_usize; i < program.size(); ++i) {
+        memcpy(rom, i * 4_usize, program[i]);
+    }
+    memcpy(rom, 0x100_usize, 0x0000'4301_u32); // 4 bit units 1, 0, 3, 4
+    memcpy(rom, 0x110_usize, 0x0804'0002_u32); // 2 bytes, 4 -> 8 bits
+    memcpy(rom, 0x114_usize, 0x0000'0010_u32); // offset non-zero units by 0x10
+    memcpy(rom, 0x120_usize, 0x0000'0481_u32); // diff8, 4 bytes
+    memcpy(rom, 0x124_usize, 0xFF02'0110_u32);
+
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_hle_unpack";
+    fs::create_directories(dir);
+    const fs::path rom_path = dir / "hle_unpack.gba";
+    fs::write_file(rom_path, rom);
+
+    core g{vector<u8>{}};
+    g.load_pak(rom_path);
+    g.tick_one_frame();
+
+    auto& bus = static_cast<cpu::bus_interface&>(g);
+    CHECK(bus.read_32(0x0200'0000_u32, cpu::mem_access::none) == 0x1413'0011_u32);
+    CHECK(bus.read_32(0x0200'0100_u32, cpu::mem_access::none) == 0x1213'1110_u32);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("native swi fast paths")
+{
+    constexpr array<u32, 16> program{
+      0xE3A0'0302_u32, // mov r0, #0x08000000
+      0xE280'0C01_u32, // add r0, r0, #0x100
+      0xE3A0'1402_u32, // mov r1, #0x02000000
+      0xEF14'0000_u32, // swi #0x14 ; RLUnCompWram
+      0xE3A0'0302_u32, // mov r0, #0x08000000
+      0xE280'0E11_u32, // add r0, r0, #0x110
+      0xE3A0'1406_u32, // mov r1, #0x06000000
+      0xEF12'0000_u32, // swi #0x12 ; LZ77UnCompVram
+      0xE3A0'0302_u32, // mov r0, #0x08000000
+      0xE280'0E12_u32, // add r0, r0, #0x120
+      0xE3A0'1402_u32, // mov r1, #0x02000000
+      0xE281'1C01_u32, // add r1, r1, #0x100
+      0xE3A0'2405_u32, // mov r2, #0x05000000 ; fill, 32 bit
+      0xE382'2008_u32, // orr r2, r2, #8
+      0xEF0B'0000_u32, // swi #0x0B ; CpuSet
+      0xEAFF'FFFE_u32, // b .
+    };
+
+    vector<u8> rom{0x200_usize};
+    for(usize i = 0_usize; i < program.size(); ++i) {
+        memcpy(rom, i * 4_usize, program[i]);
+    }
+    memcpy(rom, 0x100_usize, 0x0000'0830_u32); // rl, 8 bytes
+    memcpy(rom, 0x104_usize, 0x1101'AA83_u32); // 6 * AA, 11 22
+    memcpy(rom, 0x108_usize, 0x0000'0022_u32);
+    memcpy(rom, 0x110_usize, 0x0000'0A10_u32); // lz77, 10 bytes
+    memcpy(rom, 0x114_usize, 0x0060'4140_u32); // 41, 9 byte back reference
+    memcpy(rom, 0x120_usize, 0xDEAD'BEEF_u32);
+
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_native_swi";
+    fs::create_directories(dir);
+    const fs::path rom_path = dir / "native_swi.gba";
+    fs::write_file(rom_path, rom);
+
+    core g{vector<u8>{16_kb}};
+    g.set_native_swi_fast_paths(true);
+    g.load_pak(rom_path);
+    g.skip_bios();
+    g.tick_one_frame();
+
+    auto& bus = static_cast<cpu::bus_interface&>(g);
+    CHECK(bus.read_32(0x0200'0000_u32, cpu::mem_access::none) == 0xAAAA'AAAA_u32);
+    CHECK(bus.read_32(0x0200'0004_u32, cpu::mem_access::none) == 0x2211'AAAA_u32);
+    for(u32 addr = 0x0600'0000_u32; addr < 0x0600'000A_u32; addr += 2_u32) {
+        CHECK(bus.read_16(addr, cpu::mem_access::none) == 0x4141_u16);
+    }
+    for(u32 addr = 0x0200'0100_u32; addr < 0x0200'0120_u32; addr += 4_u32) {
+        CHECK(bus.read_32(addr, cpu::mem_access::none) == 0xDEAD'BEEF_u32);
+    }
+    CHECK(bus.read_32(0x0200'0120_u32, cpu::mem_access::none) == 0_u32);
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <random>
+
+#include <access_private.h>
+
+#include <gba/core.h>
+#include <test_prelude.h>
+
+namespace {
+
+using bg_ids = gba::static_vector<gba::ppu::bg_priority_pair, 4>;
+using bg_buffers_t = gba::array<gba::ppu::scanline_buffer, 4>;
+using obj_buffer_t = gba::array<gba::ppu::obj_buffer_entry, gba::ppu::screen_width>;
+using win_buffer_t = gba::array<gba::ppu::win_enable_bits*, gba::ppu::screen_width>;
+
+} // namespace
+
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::vector<gba::u8>, palette_ram_)
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::ppu::dispcnt, dispcnt_)
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::ppu::bldcnt, bldcnt_)
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::ppu::blend_settings, blend_settings_)
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, gba::ppu::scanline_buffer, final_buffer_)
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, bg_buffers_t, bg_buffers_)
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, obj_buffer_t, obj_buffer_)
+ACCESS_PRIVATE_FIELD(gba::ppu::engine, win_buffer_t, win_buffer_)
+ACCESS_PRIVATE_FUN(gba::ppu::engine, void(const bg_ids&) noexcept, compose_simd)
+ACCESS_PRIVATE_FUN(gba::ppu::engine, void(const bg_ids&) noexcept, compose_scalar)
+
+using namespace gba;
+
+TEST_CASE("simd compositor matches the scalar one")
+{
+    gba::scheduler scheduler;
+    ppu::engine engine{&scheduler};
+
+    std::mt19937 rng{0x6BA};
+    const auto random = [&](const u32 max) { return u32(std::uniform_int_distribution<u32::type>{0u, max.get()}(rng)); };
+    // transparent dots often enough to let lower layers through
+    const auto random_dot = [&]() {
+        return random(3_u32) == 0_u32 ? ppu::color::transparent() : ppu::color{narrow<u16>(random(0x7FFF_u32))};
+    };
+
+    array<ppu::win_enable_bits, 4> win_enables;
+    for(const ppu::bldcnt::effect effect : {ppu::bldcnt::effect::none, ppu::bldcnt::effect::alpha_blend,
+                                            ppu::bldcnt::effect::brightness_inc, ppu::bldcnt::effect::brightness_dec}) {
+        for(u32 round : range(64_u32)) {
+            const u32 effect_idx = from_enum<u32>(effect);
+            CAPTURE(effect_idx);
+            CAPTURE(round);
+
+            ppu::dispcnt& dispcnt = access_private::dispcnt_(engine);
+            dispcnt.obj_enabled = random(1_u32) == 1_u32;
+            dispcnt.win0_enabled = random(1_u32) == 1_u32;
+            dispcnt.win1_enabled = false;
+            dispcnt.win_obj_enabled = false;
+
+            ppu::bldcnt& bldcnt = access_private::bldcnt_(engine);
+            bldcnt.type = effect;
+            bldcnt.first.write(narrow<u8>(random(0x3F_u32)));
+            bldcnt.second.write(narrow<u8>(random(0x3F_u32)));
+
+            // out of range coefficients are clamped to 16
+            ppu::blend_settings& blend_settings = access_private::blend_settings_(engine);
+            blend_settings.eva = narrow<u8>(random(0x1F_u32));
+            blend_settings.evb = narrow<u8>(random(0x1F_u32));
+            blend_settings.evy = narrow<u8>(random(0x1F_u32));
+
+            vector<u8>& palette_ram = access_private::palette_ram_(engine);
+            palette_ram[0_usize] = narrow<u8>(random(0xFF_u32));
+            palette_ram[1_usize] = narrow<u8>(random(0xFF_u32));
+
+            for(ppu::win_enable_bits& bits : win_enables) {
+                bits.write(narrow<u8>(random(0x3F_u32)));
+            }
+
+            for(u32 x : range(ppu::screen_width)) {
+                for(ppu::scanline_buffer& buffer : access_private::bg_buffers_(engine)) {
+                    buffer[x] = random_dot();
+                }
+
+                ppu::obj_buffer_entry& obj = access_private::obj_buffer_(engine)[x];
+                obj.dot = random_dot();
+                obj.priority = random(3_u32);
+                obj.is_alpha_blending = random(1_u32) == 1_u32;
+
+                // runs of the same window like the window buffer has
+                access_private::win_buffer_(engine)[x] = &win_enables[(x / 24_u32) % 4_u32];
+            }
+
+            // enabled bgs in least importance order, same as compose_impl
+            bg_ids ids;
+            array<u32, 4> priorities;
+            for(u32 bg : range(4_u32)) {
+                priorities[bg] = random(3_u32);
+            }
+            for(u32 priority = 4_u32; priority > 0_u32; --priority) {
+                for(u32 bg = 4_u32; bg > 0_u32; --bg) {
+                    if(priorities[bg - 1_u32] == priority - 1_u32 && random(3_u32) != 0_u32) {
+                        ids.push_back({priority - 1_u32, bg - 1_u32});
+                    }
+                }
+            }
+
+            call_private::compose_scalar(engine, ids);
+            const ppu::scanline_buffer expected = access_private::final_buffer_(engine);
+            call_private::compose_simd(engine, ids);
+            const ppu::scanline_buffer& actual = access_private::final_buffer_(engine);
+
+            for(u32 x : range(ppu::screen_width)) {
+                CAPTURE(x);
+                REQUIRE(actual[x].val == expected[x].val);
+            }
+        }
+    }
+}
+
+TEST_CASE("threaded ppu")
+{
+    struct frame_capture {
+        vector<ppu::scanline_buffer> lines;
+        vector<u8> line_numbers;
+
+        void on_scanline(const u8 line, const ppu::scanline_buffer& buffer)
+        {
+            line_numbers.push_back(line);
+            lines.push_back(buffer);
+        }
+    };
+
+    const auto run = [](const bool threaded) {
+        frame_capture capture;
+        core g{vector<u8>{}};
+        g.on_scanline_event().add_delegate({connect_arg<&frame_capture::on_scanline>, &capture});
+        g.load_pak(fs::current_path() / "res" / "ARM_Any.gba");
+
+        // switch over mid run, the worker must pick up the video memory written until then
+        for(int i = 0; i < 20; ++i) {
+            g.tick_one_frame();
+        }
+        g.set_threaded_rendering(threaded);
+        CHECK(g.threaded_rendering() == threaded);
+        for(int i = 0; i < 20; ++i) {
+            g.tick_one_frame();
+        }
+        return capture;
+    };
+
+    const frame_capture sync = run(false);
+    const frame_capture threaded = run(true);
+
+    REQUIRE(sync.lines.size() == 40_usize * ppu::screen_height);
+    REQUIRE(threaded.lines.size() == sync.lines.size());
+    CHECK(std::equal(sync.line_numbers.begin(), sync.line_numbers.end(), threaded.line_numbers.begin()));
+    for(usize i = 0_usize; i < sync.lines.size(); ++i) {
+        const ppu::scanline_buffer& expected = sync.lines[i];
+        const ppu::scanline_buffer& actual = threaded.lines[i];
+        INFO("line: ", sync.line_numbers[i].get(), " of frame: ", (i / ppu::screen_height).get());
+        REQUIRE(std::equal(expected.begin(), expected.end(), actual.begin()));
+    }
+}
+
+TEST_CASE("decoded tile cache")
+{
+    vector<u8> rom{0x200_usize};
+    memcpy(rom, 0_usize, 0xEAFF'FFFE_u32); // b .
+
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_tile_cache";
+    fs::create_directories(dir);
+    const fs::path rom_path = dir / "tile_cache.gba";
+    fs::write_file(rom_path, rom);
+
+    struct first_dot_capture {
+        ppu::color dot;
+
+        void on_scanline(const u8 line, const ppu::scanline_buffer& buffer)
+        {
+            if(line == 0_u8) {
+                dot = buffer[0_usize];
+            }
+        }
+    };
+
+    first_dot_capture capture;
+    core g{vector<u8>{}};
+    g.on_scanline_event().add_delegate({connect_arg<&first_dot_capture::on_scanline>, &capture});
+    g.load_pak(rom_path);
+    g.skip_bios();
+
+    // bg0 in mode 0, every map entry points to tile 0 of char block 0
+    auto& bus = static_cast<cpu::bus_interface&>(g);
+    bus.write_16(0x0400'0000_u32, 0x0100_u16, cpu::mem_access::non_seq);
+    bus.write_16(0x0400'0008_u32, 0x0800_u16, cpu::mem_access::non_seq);
+    bus.write_32(0x0600'0000_u32, 0x1111'1111_u32, cpu::mem_access::non_seq);
+    bus.write_16(0x0500'0002_u32, 0x001F_u16, cpu::mem_access::non_seq);
+
+    g.tick_one_frame();
+    CHECK(capture.dot == ppu::color{0x001F_u16});
+
+    bus.write_16(0x0500'0002_u32, 0x03E0_u16, cpu::mem_access::non_seq);
+    g.tick_one_frame();
+    CHECK(capture.dot == ppu::color{0x03E0_u16});
+
+    bus.write_16(0x0500'0004_u32, 0x7C00_u16, cpu::mem_access::non_seq);
+    bus.write_8(0x0600'0000_u32, 0x22_u8, cpu::mem_access::non_seq);
+    g.tick_one_frame();
+    CHECK(capture.dot == ppu::color{0x7C00_u16});
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("obj line lists")
+{
+    vector<u8> rom{0x200_usize};
+    memcpy(rom, 0_usize, 0xEAFF'FFFE_u32); // b .
+
+    const fs::path dir = fs::temp_directory_path() / "gameboiadvance_obj_lines";
+    fs::create_directories(dir);
+    const fs::path rom_path = dir / "obj_lines.gba";
+    fs::write_file(rom_path, rom);
+
+    struct first_dot_capture {
+        array<ppu::color, ppu::screen_height> dots;
+
+        void on_scanline(const u8 line, const ppu::scanline_buffer& buffer)
+        {
+            dots[line] = buffer[0_usize];
+        }
+    };
+
+    first_dot_capture capture;
+    core g{vector<u8>{}};
+    g.on_scanline_event().add_delegate({connect_arg<&first_dot_capture::on_scanline>, &capture});
+    g.load_pak(rom_path);
+    g.skip_bios();
+
+    // objs only, 1d mapping, one 8x8 obj with a solid first row and every other obj hidden
+    auto& bus = static_cast<cpu::bus_interface&>(g);
+    bus.write_16(0x0400'0000_u32, 0x1040_u16, cpu::mem_access::non_seq);
+    bus.write_32(0x0601'0000_u32, 0x1111'1111_u32, cpu::mem_access::non_seq);
+    bus.write_16(0x0500'0202_u32, 0x001F_u16, cpu::mem_access::non_seq);
+    for(u32 obj = 1_u32; obj < 128_u32; ++obj) {
+        bus.write_16(0x0700'0000_u32 + obj * 8_u32, 0x0200_u16, cpu::mem_access::non_seq);
+    }
+
+    const ppu::color obj_color{0x001F_u16};
+    bus.write_16(0x0700'0000_u32, 10_u16, cpu::mem_access::non_seq);
+    g.tick_one_frame();
+    CHECK(capture.dots[9_usize] != obj_color);
+    CHECK(capture.dots[10_usize] == obj_color);
+    CHECK(capture.dots[11_usize] != obj_color);
+
+    bus.write_16(0x0700'0000_u32, 20_u16, cpu::mem_access::non_seq);
+    g.tick_one_frame();
+    CHECK(capture.dots[10_usize] != obj_color);
+    CHECK(capture.dots[20_usize] == obj_color);
+
+    // wraps around from the bottom
+    bus.write_16(0x0700'0000_u32, 255_u16, cpu::mem_access::non_seq);
+    g.tick_one_frame();
+    CHECK(capture.dots[0_usize] != obj_color);
+    CHECK(capture.dots[20_usize] != obj_color);
+
+    bus.write_16(0x0700'0000_u32, 0x0200_u16, cpu::mem_access::non_seq);
+    bus.write_16(0x0700'0008_u32, 30_u16, cpu::mem_access::non_seq);
+    g.tick_one_frame();
+    CHECK(capture.dots[30_usize] == obj_color);
+
+    fs::remove_all(dir);
+}
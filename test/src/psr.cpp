@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <gba/cpu/arm7tdmi.h>
+#include <test_prelude.h>
+
+using namespace gba;
+
+namespace {
+
+constexpr array<u32, 8> operands{
+  0x0000'0000_u32, 0x0000'0001_u32, 0x7FFF'FFFF_u32, 0x8000'0000_u32,
+  0x8000'0001_u32, 0xFFFF'FFFE_u32, 0xFFFF'FFFF_u32, 0x1234'5678_u32
+};
+
+} // namespace
+
+TEST_CASE("psr lazy flags")
+{
+    SUBCASE("add and sub") {
+        for(const u32 a : operands) {
+            for(const u32 b : operands) {
+                for(const bool carry : {false, true}) {
+                    const u64 sum = widen<u64>(a) + b + bit::from_bool(carry);
+                    const u32 sum32 = narrow<u32>(sum);
+
+                    cpu::psr add;
+                    add.set_add(a, b, carry, sum32);
+                    CHECK(add.n() == bit::test(sum32, 31_u8));
+                    CHECK(add.z() == (sum32 == 0_u32));
+                    CHECK(add.c() == bit::test(sum, 32_u8));
+                    CHECK(add.v() == bit::test(~(a ^ b) & (b ^ sum32), 31_u8));
+
+                    const u32 diff = a - b - bit::from_bool(!carry);
+                    cpu::psr sub;
+                    sub.set_sub(a, b, carry, diff);
+                    CHECK(sub.n() == bit::test(diff, 31_u8));
+                    CHECK(sub.z() == (diff == 0_u32));
+                    CHECK(sub.c() == (a >= widen<u64>(b) + bit::from_bool(!carry)));
+                    CHECK(sub.v() == bit::test((a ^ b) & (a ^ diff), 31_u8));
+                }
+            }
+        }
+    }
+
+    SUBCASE("carry write keeps overflow") {
+        cpu::psr p;
+        p.set_add(0x7FFF'FFFF_u32, 1_u32, false, 0x8000'0000_u32);
+        p.set_nz(0_u32);
+        p.set_c(false);
+        CHECK(p.z());
+        CHECK_FALSE(p.n());
+        CHECK_FALSE(p.c());
+        CHECK(p.v());
+    }
+
+    SUBCASE("transfer") {
+        cpu::psr p;
+        p = 0xF000'001F_u32;
+        CHECK(p.n());
+        CHECK(p.z());
+        CHECK(p.c());
+        CHECK(p.v());
+        CHECK(static_cast<u32>(p) == 0xF000'001F_u32);
+
+        p.set_sub(1_u32, 1_u32, true, 0_u32);
+        CHECK(static_cast<u32>(p) == 0x6000'001F_u32);
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <string_view>
+
+#include <access_private.h>
+
+#include <gba/core.h>
+#include <gba/helper/gzip.h>
+#include <test_prelude.h>
+
+ACCESS_PRIVATE_FIELD(gba::core, gba::cartridge::gamepak, gamepak_)
+ACCESS_PRIVATE_FIELD(gba::cartridge::gamepak, std::shared_ptr<const gba::cartridge::rom_image>, pak_data_)
+
+using namespace gba;
+
+TEST_CASE("shared rom image")
+{
+    const fs::path rom_path = fs::current_path() / "res" / "ARM_Any.gba";
+    const vector<u8> rom_bytes = fs::read_file(rom_path);
+
+    const auto check_shared = [&](const fs::path& path, const bool mapped) {
+        core first{vector<u8>{}};
+        core second{vector<u8>{}};
+        first.load_pak(path);
+        second.load_pak(path);
+
+        const auto& image = access_private::pak_data_(access_private::gamepak_(first));
+        CHECK(image == access_private::pak_data_(access_private::gamepak_(second)));
+        CHECK(image->is_mapped() == mapped);
+        REQUIRE(image->size() == rom_bytes.size());
+        CHECK(std::equal(image->begin(), image->end(), rom_bytes.begin()));
+        CHECK(first.game_title() == second.game_title());
+        CHECK(first.pak_load_stats().mapped == mapped);
+        CHECK(first.pak_load_stats().rom_size == rom_bytes.size());
+    };
+
+    SUBCASE("mapped") {
+        check_shared(rom_path, true);
+    }
+
+    SUBCASE("decompressed") {
+        const fs::path dir = fs::temp_directory_path() / "gameboiadvance_rom_image";
+        fs::create_directories(dir);
+        const fs::path gz_path = dir / "ARM_Any.gba.gz";
+        fs::write_file(gz_path, gzip::compress(rom_bytes).value());
+
+        check_shared(gz_path, false);
+        fs::remove_all(dir);
+    }
+
+    SUBCASE("backup signature scan") {
+        const fs::path dir = fs::temp_directory_path() / "gameboiadvance_rom_image";
+        fs::create_directories(dir);
+
+        // found the same whether the image is mapped or inflated
+        vector<u8> rom{64_kb};
+        constexpr std::string_view signature = "FLASH1M_V102";
+        std::copy(signature.begin(), signature.end(), reinterpret_cast<char*>(rom.ptr(4_kb - 4_usize))); // NOLINT
+
+        fs::write_file(dir / "flash.gba", rom);
+        fs::write_file(dir / "flash.gba.gz", gzip::compress(rom).value());
+
+        CHECK(cartridge::rom_image::open(dir / "flash.gba")->scan_backup_type() == cartridge::backup::type::flash_128);
+        CHECK(cartridge::rom_image::open(dir / "flash.gba.gz")->scan_backup_type() == cartridge::backup::type::flash_128);
+        CHECK(cartridge::rom_image::open(dir / "flash.gba")->scan_backup_signature().offset == 4_kb - 4_usize);
+        CHECK(cartridge::rom_image::open(dir / "flash.gba.gz")->scan_backup_signature().offset == 4_kb - 4_usize);
+
+        // the second load reads the scan result from the cache
+        for(const bool cached : {false, true}) {
+            core g{vector<u8>{}};
+            g.load_pak(dir / "flash.gba");
+            CHECK(g.pak_load_stats().backup_scan_cached == cached);
+            CHECK(access_private::gamepak_(g).backup_type() == cartridge::backup::type::flash_128);
+        }
+
+        // same size and another signature at the same offset, must not reuse the result
+        constexpr std::string_view sram_signature = "SRAM_V113";
+        std::copy(sram_signature.begin(), sram_signature.end(), reinterpret_cast<char*>(rom.ptr(4_kb - 4_usize))); // NOLINT
+        fs::write_file(dir / "sram.gba", rom);
+        for(const bool cached : {false, true}) {
+            core g{vector<u8>{}};
+            g.load_pak(dir / "sram.gba");
+            CHECK(g.pak_load_stats().backup_scan_cached == cached);
+            CHECK(access_private::gamepak_(g).backup_type() == cartridge::backup::type::sram);
+        }
+
+        // nothing to verify a cached miss against, so it is never cached
+        std::fill(rom.begin(), rom.end(), 0_u8);
+        fs::write_file(dir / "none.gba", rom);
+        for(int i = 0; i < 2; ++i) {
+            core g{vector<u8>{}};
+            g.load_pak(dir / "none.gba");
+            CHECK_FALSE(g.pak_load_stats().backup_scan_cached);
+        }
+        fs::remove_all(dir);
+    }
+}
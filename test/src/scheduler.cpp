@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2020  emrsmsrli
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <gba/archive.h>
+#include <gba/core/scheduler.h>
+#include <test_prelude.h>
+
+using namespace gba;
+
+namespace {
+
+struct event_recorder {
+    vector<u32> fired;
+    vector<u32> late_cycles;
+
+    template<u32::type Id>
+    void on_event(const u32 late) noexcept
+    {
+        fired.push_back(Id);
+        late_cycles.push_back(late);
+    }
+};
+
+} // namespace
+
+TEST_CASE("scheduler")
+{
+    event_recorder recorder;
+    scheduler s;
+
+    const delegate<void(u32)> ev0 = MAKE_HW_EVENT_V(event_recorder::on_event<0>, &recorder);
+    const delegate<void(u32)> ev1 = MAKE_HW_EVENT_V(event_recorder::on_event<1>, &recorder);
+    const delegate<void(u32)> ev2 = MAKE_HW_EVENT_V(event_recorder::on_event<2>, &recorder);
+
+    SUBCASE("fires in timestamp order") {
+        s.add_hw_event(30_u32, ev2);
+        s.add_hw_event(10_u32, ev0);
+        s.add_hw_event(20_u32, ev1);
+
+        s.add_cycles(25_u32);
+        REQUIRE(recorder.fired.size() == 2_usize);
+        CHECK(recorder.fired[0_usize] == 0_u32);
+        CHECK(recorder.fired[1_usize] == 1_u32);
+        CHECK(recorder.late_cycles[0_usize] == 15_u32);
+        CHECK(recorder.late_cycles[1_usize] == 5_u32);
+        CHECK(s.remaining_cycles_to_next_event() == 5_u32);
+    }
+
+    SUBCASE("ties fire in scheduling order") {
+        s.add_hw_event(10_u32, ev2);
+        s.add_hw_event(10_u32, ev0);
+        s.add_hw_event(10_u32, ev1);
+
+        s.add_cycles(10_u32);
+        REQUIRE(recorder.fired.size() == 3_usize);
+        CHECK(recorder.fired[0_usize] == 2_u32);
+        CHECK(recorder.fired[1_usize] == 0_u32);
+        CHECK(recorder.fired[2_usize] == 1_u32);
+    }
+
+    SUBCASE("scheduling an earlier event mid run") {
+        s.add_hw_event(100_u32, ev0);
+        s.add_cycles(50_u32);
+        CHECK(s.now() == 50_u64);
+
+        s.add_hw_event(10_u32, ev1);
+        CHECK(s.remaining_cycles_to_next_event() == 10_u32);
+
+        s.add_cycles(10_u32);
+        REQUIRE(recorder.fired.size() == 1_usize);
+        CHECK(recorder.fired[0_usize] == 1_u32);
+        CHECK(recorder.late_cycles[0_usize] == 0_u32);
+        CHECK(s.remaining_cycles_to_next_event() == 40_u32);
+    }
+
+    SUBCASE("cancel") {
+        s.add_hw_event(10_u32, ev0);
+        const scheduler::hw_event::handle h = s.add_hw_event(20_u32, ev1);
+        s.add_hw_event(30_u32, ev2);
+
+        CHECK(s.has_event(h));
+        s.remove_event(h);
+        CHECK_FALSE(s.has_event(h));
+        s.remove_event(h); // no-op
+
+        s.add_cycles(30_u32);
+        REQUIRE(recorder.fired.size() == 2_usize);
+        CHECK(recorder.fired[0_usize] == 0_u32);
+        CHECK(recorder.fired[1_usize] == 2_u32);
+    }
+
+    SUBCASE("fired events are gone") {
+        const scheduler::hw_event::handle h = s.add_hw_event(10_u32, ev0);
+        s.add_hw_event(20_u32, ev1);
+        s.add_cycles(10_u32);
+        CHECK_FALSE(s.has_event(h));
+    }
+
+    SUBCASE("many events") {
+        vector<scheduler::hw_event::handle> handles;
+        for(u32 i = 0_u32; i < 200_u32; ++i) {
+            handles.push_back(s.add_hw_event(1000_u32 - i, ev0));
+        }
+        for(u32 i = 0_u32; i < 200_u32; i += 2_u32) {
+            s.remove_event(handles[i]);
+        }
+
+        for(u32 i = 0_u32; i < 200_u32; ++i) {
+            CHECK(s.has_event(handles[i]) == ((i % 2_u32) == 1_u32));
+        }
+
+        s.add_cycles(1000_u32);
+        CHECK(recorder.fired.size() == 100_usize);
+        for(const u32 late : recorder.late_cycles) {
+            CHECK(late < 200_u32);
+        }
+    }
+
+    SUBCASE("fixed sources") {
+        s.add_hw_event(10_u32, ev0);
+        const scheduler::hw_event::handle h = s.add_hw_event(scheduler::event_source::timer0, 10_u32, ev1);
+        s.add_hw_event(scheduler::event_source::ppu, 5_u32, ev2);
+        CHECK(s.remaining_cycles_to_next_event() == 5_u32);
+
+        // busy source falls back to the heap
+        const scheduler::hw_event::handle busy = s.add_hw_event(scheduler::event_source::timer0, 10_u32, ev2);
+        CHECK(s.has_event(h));
+        CHECK(s.has_event(busy));
+
+        s.remove_event(busy);
+        CHECK_FALSE(s.has_event(busy));
+
+        s.add_cycles(10_u32);
+        REQUIRE(recorder.fired.size() == 3_usize);
+        CHECK(recorder.fired[0_usize] == 2_u32);
+        CHECK(recorder.fired[1_usize] == 0_u32);
+        CHECK(recorder.fired[2_usize] == 1_u32);
+        CHECK_FALSE(s.has_event(h));
+
+        const scheduler::hw_event::handle irq = s.add_hw_event(scheduler::event_source::irq, 1_u32, ev0);
+        s.remove_event(irq);
+        s.remove_event(irq); // no-op
+        s.add_hw_event(scheduler::event_source::irq, 2_u32, ev1);
+        s.add_cycles(2_u32);
+        REQUIRE(recorder.fired.size() == 4_usize);
+        CHECK(recorder.fired[3_usize] == 1_u32);
+    }
+
+    SUBCASE("serialize") {
+        s.event_registry().register_entry(ev0, "test::ev0");
+        s.event_registry().register_entry(ev1, "test::ev1");
+
+        s.add_hw_event(10_u32, ev0);
+        const scheduler::hw_event::handle h = s.add_hw_event(scheduler::event_source::apu_mixer, 20_u32, ev1);
+
+        archive archive;
+        s.serialize(archive);
+
+        scheduler restored;
+        restored.event_registry().register_entry(ev0, "test::ev0");
+        restored.event_registry().register_entry(ev1, "test::ev1");
+        restored.deserialize(archive);
+        CHECK(restored.now() == s.now());
+        CHECK(restored.has_event(h));
+
+        restored.add_cycles(20_u32);
+        REQUIRE(recorder.fired.size() == 2_usize);
+        CHECK(recorder.fired[0_usize] == 0_u32);
+        CHECK(recorder.fired[1_usize] == 1_u32);
+    }
+}